@@ -0,0 +1,94 @@
+#include <bench.hpp>
+#include <cstdio>
+#include <headless.hpp>
+#include <javascript/function.hpp>
+#include <json/parser.hpp>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Case
+    {
+        const char *name;
+        Webview::Function function;
+        std::string params;
+        std::size_t calls; //* Calls in one message
+        std::size_t times;
+    };
+
+    std::string message(const Case &bench)
+    {
+        std::string rtn = "[";
+        for (std::size_t i = 0; bench.calls > i; i++)
+        {
+            rtn += (i ? ",{" : "{");
+            rtn += R"("function":0,"seq":)" + std::to_string(i) + R"(,"params":)" + bench.params + "}";
+        }
+
+        return rtn + "]";
+    }
+} // namespace
+
+int main()
+{
+    Webview::HeadlessWindow window;
+
+    std::string vector = "[[";
+    for (std::size_t i = 0; 1000000 > i; i++)
+    {
+        vector += (i ? ",0." : "0.") + std::to_string(i % 1000);
+    }
+    vector += "]]";
+
+    Case cases[] = {
+        {"small call (int, string)",
+         Webview::Function("small", [](int a, const std::string &b) { return a + static_cast<int>(b.size()); }),
+         R"([42,"some text"])", 1, 100000},
+        {"batch of 100 small calls",
+         Webview::Function("small", [](int a, const std::string &b) { return a + static_cast<int>(b.size()); }),
+         R"([42,"some text"])", 100, 1000},
+        {"vector<double>, 1M elements",
+         Webview::Function("vector", [](const std::vector<double> &values) { return values.size(); }), vector, 1,
+         10},
+        {"10 MiB string", Webview::Function("string", [](const std::string &value) { return value.size(); }),
+         "[\"" + std::string(10 << 20, 'a') + "\"]", 1, 10},
+    };
+
+    std::printf("%28s %14s %14s\n", "", "json document", "sax");
+
+    for (auto &bench : cases)
+    {
+        const auto raw = message(bench);
+        std::size_t domResults = 0;
+        std::size_t saxResults = 0;
+
+        //* How calls were handled before, the whole message is parsed into a json document first
+        const auto dom = Webview::Bench::measure(bench.times, [&](std::size_t) {
+            const auto parsed = nlohmann::json::parse(raw);
+            for (const auto &call : parsed)
+            {
+                domResults += bench.function.getFunc()(call.at("params")).get<std::size_t>();
+            }
+        });
+
+        //* The parameters are parsed straight into the arguments of the function
+        const auto sax = Webview::Bench::measure(bench.times, [&](std::size_t) {
+            Webview::CallParser parser([&bench](std::uint32_t) { return bench.function.makeArguments(); });
+            nlohmann::json::sax_parse(raw, &parser);
+
+            for (auto &request : parser.getRequests())
+            {
+                saxResults += request.arguments->invoke(window, request.id()).get<std::size_t>();
+            }
+        });
+
+        std::printf("%28s %11.2f us %11.2f us (%.1fx)\n", bench.name, dom / 1e3, sax / 1e3, dom / sax);
+
+        if (domResults != saxResults)
+        {
+            std::printf("the functions were called with different arguments\n");
+            return 1;
+        }
+    }
+}
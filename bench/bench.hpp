@@ -0,0 +1,20 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+
+namespace Webview::Bench
+{
+    /// \effects Calls the given function the given amount of times
+    /// \returns How long a call took on average, in nanoseconds
+    template <typename Func> double measure(std::size_t times, Func &&func)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; times > i; i++)
+        {
+            func(i);
+        }
+
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               static_cast<double>(times);
+    }
+} // namespace Webview::Bench
@@ -0,0 +1,43 @@
+#include <bench.hpp>
+#include <cstdio>
+#include <json/binary.hpp>
+#include <json/builder.hpp>
+#include <json/codec.hpp>
+#include <memory>
+#include <string>
+
+int main()
+{
+    //* Shaped like the result of a call, some metadata and a larger array of records
+    nlohmann::json value;
+    value["name"] = "result";
+    value["complete"] = true;
+    for (int i = 0; 1000 > i; i++)
+    {
+        value["items"].push_back({{"id", i}, {"score", i * 0.25}, {"label", "item " + std::to_string(i)}});
+    }
+
+    constexpr std::size_t times = 500;
+    const std::pair<const char *, std::shared_ptr<Webview::Codec>> codecs[] = {
+        {"json", std::make_shared<Webview::JsonCodec>()},
+        {"cbor", std::make_shared<Webview::CborCodec>()},
+        {"msgpack", std::make_shared<Webview::MessagePackCodec>()},
+    };
+
+    for (const auto &[name, codec] : codecs)
+    {
+        std::string encoded;
+        const auto encode = Webview::Bench::measure(times, [&](std::size_t) { encoded = codec->encode(value); });
+
+        //* Binary codecs are sent as base64, which is what javascript hands back as well
+        const auto message = codec->isBinary() ? Webview::Binary::encode(encoded.data(), encoded.size()) : encoded;
+
+        const auto decode = Webview::Bench::measure(times, [&](std::size_t) {
+            Webview::JsonBuilder builder;
+            codec->decode(message, builder);
+        });
+
+        std::printf("%7s: %6zu bytes, encode %.1f us, decode %.1f us\n", name, message.size(), encode / 1e3,
+                    decode / 1e3);
+    }
+}
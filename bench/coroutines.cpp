@@ -0,0 +1,64 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <headless.hpp>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <string>
+
+namespace
+{
+    //* Answers every javascript call on the main thread, like a page whose functions return right away
+    class RespondingWindow : public Webview::HeadlessWindow
+    {
+      protected:
+        void runCall(std::uint32_t seq, [[maybe_unused]] const std::string &call) override
+        {
+            dispatch([this, seq] { handleRawCallRequest("{\"seq\":" + std::to_string(seq) + ",\"result\":1}", 0); },
+                     {});
+        }
+    };
+
+    //* Runs the given amount of calls of the function with the given id and returns how long one took on average
+    double run(RespondingWindow &window, std::uint32_t function, std::size_t calls, std::atomic<std::size_t> &done)
+    {
+        done = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (std::size_t i = 0; calls > i; i++)
+        {
+            window.handleRawCallRequest("[{\"function\":" + std::to_string(function) +
+                                            ",\"seq\":" + std::to_string(i) + ",\"params\":[]}]",
+                                        0);
+        }
+
+        while (done < calls)
+        {
+            window.step();
+        }
+
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() /
+               static_cast<double>(calls);
+    }
+} // namespace
+
+int main()
+{
+    RespondingWindow window;
+    std::atomic<std::size_t> done = 0;
+
+    //* A suspended coroutine holds no thread, a call that waits on its future blocks a worker until it is answered
+    window.expose(Webview::AsyncFunction("coroutine", [&window, &done]() -> Webview::Task<int> {
+        const auto result = co_await window.call<int>(Webview::JavaScriptFunction("answer"));
+        done++;
+        co_return result;
+    }));
+    window.expose(Webview::AsyncFunction("future", [&window, &done](Webview::Promise promise) {
+        promise.resolve(window.callFunction<int>(Webview::JavaScriptFunction("answer")).get());
+        done++;
+    }));
+
+    constexpr std::size_t calls = 10000;
+    std::printf("%zu calls: coroutine %.2f us/call, future %.2f us/call\n", calls, run(window, 0, calls, done),
+                run(window, 1, calls, done));
+}
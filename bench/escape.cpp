@@ -0,0 +1,62 @@
+#include <bench.hpp>
+#include <cstdio>
+#include <headless.hpp>
+#include <legacy.hpp>
+#include <string>
+
+namespace
+{
+    //* Enough rounds to pass about this many bytes through an implementation, but at least one
+    std::size_t rounds(std::size_t bytes, std::size_t size)
+    {
+        return bytes / size ? bytes / size : 1;
+    }
+} // namespace
+
+int main()
+{
+    Webview::HeadlessWindow window;
+
+    constexpr std::size_t sizes[] = {100, 10 << 10, 1 << 20, 10 << 20, 50 << 20};
+    constexpr std::size_t bytes = 200 << 20;
+    constexpr std::size_t regexBytes = 20 << 20; //* The regex passes are two orders of magnitude slower
+
+    std::printf("%9s %16s %16s %16s %16s\n", "size", "plain", "plain (regex)", "json", "json (regex)");
+
+    for (const auto size : sizes)
+    {
+        //* Plain code is returned as it is, code with many characters to escape is copied into the buffer
+        const std::string plain(size, 'a');
+        std::string json;
+        while (json.size() < size)
+        {
+            json += R"({"text":"line\nwith\ttabs and \"quotes\""},)";
+        }
+        json.resize(size);
+
+        std::printf("%9zu", size);
+
+        const std::string *codes[] = {&plain, &json};
+        for (const auto *code : codes)
+        {
+            std::string buffer;
+            const auto ns = Webview::Bench::measure(rounds(bytes, size),
+                                                    [&](std::size_t) { window.formatCode(*code, buffer); });
+
+            std::string legacy;
+            const auto regexNs = Webview::Bench::measure(
+                rounds(regexBytes, size), [&](std::size_t) { legacy = Webview::Legacy::formatCode(*code); });
+
+            if (legacy != window.formatCode(*code, buffer))
+            {
+                std::printf("\nthe escaped code differs from the regex passes\n");
+                return 1;
+            }
+
+            std::printf(" %11.0f MB/s %11.1f MB/s", static_cast<double>(size) * 1e3 / ns,
+                        static_cast<double>(size) * 1e3 / regexNs);
+        }
+
+        std::printf("\n");
+    }
+}
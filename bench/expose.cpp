@@ -0,0 +1,84 @@
+#include <bench.hpp>
+#include <chrono>
+#include <cstdio>
+#include <headless.hpp>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace
+{
+    //* How `expose` told the kinds apart before, a failed cast throws for every function that is not async
+    std::shared_ptr<Webview::Function> byCast(const Webview::Function &function)
+    {
+        try
+        {
+            return std::make_shared<Webview::AsyncFunction>(dynamic_cast<const Webview::AsyncFunction &>(function));
+        }
+        catch ([[maybe_unused]] const std::bad_cast &e)
+        {
+            return std::make_shared<Webview::Function>(function);
+        }
+    }
+
+    std::shared_ptr<Webview::Function> byKind(const Webview::Function &function)
+    {
+        if (function.getKind() == Webview::Function::Kind::Async)
+        {
+            return std::make_shared<Webview::AsyncFunction>(static_cast<const Webview::AsyncFunction &>(function));
+        }
+
+        return std::make_shared<Webview::Function>(function);
+    }
+} // namespace
+
+int main()
+{
+    constexpr std::size_t count = 800;
+
+    std::vector<Webview::Function> functions;
+    std::vector<Webview::AsyncFunction> asyncFunctions;
+
+    for (std::size_t i = 0; count > i; i++)
+    {
+        functions.emplace_back("function" + std::to_string(i), [](int a, int b) { return a + b; });
+        asyncFunctions.emplace_back("asyncFunction" + std::to_string(i),
+                                    [](Webview::Promise promise, int a) { promise.resolve(a); });
+    }
+
+    const Webview::Function &sync = functions.front();
+    const Webview::Function &async = asyncFunctions.front();
+
+    constexpr std::size_t times = 100000;
+    std::printf("copying a function by its kind, dynamic_cast vs tag: sync %.0f vs %.0f ns, async %.0f vs %.0f ns\n",
+                Webview::Bench::measure(times, [&](std::size_t) { byCast(sync); }),
+                Webview::Bench::measure(times, [&](std::size_t) { byKind(sync); }),
+                Webview::Bench::measure(times, [&](std::size_t) { byCast(async); }),
+                Webview::Bench::measure(times, [&](std::size_t) { byKind(async); }));
+
+    for (int round = 0; 3 > round; round++)
+    {
+        Webview::HeadlessWindow window;
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &function : functions)
+        {
+            window.expose(function);
+        }
+        const auto syncUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (const auto &function : asyncFunctions)
+        {
+            window.expose(function);
+        }
+        const auto asyncUs =
+            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("exposing %zu functions: %.0f us (%.2f us each), %zu async functions: %.0f us (%.2f us each)\n",
+                    count, syncUs, syncUs / count, count, asyncUs, asyncUs / count);
+    }
+}
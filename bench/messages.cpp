@@ -0,0 +1,63 @@
+#include <bench.hpp>
+#include <core/linux/reader.hpp>
+#include <cstdio>
+#include <json/builder.hpp>
+#include <json/codec.hpp>
+#include <memory>
+#include <string>
+
+namespace
+{
+    //* Builds the messages in javascript, shaped like a call with a single parameter
+    constexpr auto nested = R"js(
+(function nested(depth) {
+    if (depth === 0) return {a: 1, b: "text", c: [1.5, true, null]};
+    return {left: nested(depth - 1), right: nested(depth - 1), n: depth};
+})
+)js";
+
+    constexpr auto numbers = R"js(
+(function numbers() {
+    const result = [];
+    for (let i = 0; 100000 > i; i++) result.push(i * 0.5);
+    return result;
+})
+)js";
+} // namespace
+
+int main()
+{
+    std::unique_ptr<JSCContext, decltype(&g_object_unref)> context(jsc_context_new(), g_object_unref);
+
+    const Webview::JsonCodec codec;
+    constexpr std::size_t times = 100;
+
+    const std::pair<const char *, std::string> messages[] = {
+        {"nested", std::string("[{function: 0, seq: 1, params: [") + nested + "(10)]}]"},
+        {"array", std::string("[{function: 0, seq: 1, params: [") + numbers + "()]}]"},
+    };
+
+    for (const auto &[name, script] : messages)
+    {
+        Webview::Value value(jsc_context_evaluate(context.get(), script.c_str(), -1));
+
+        //* Without structured messages javascript stringifies the message and the window parses it again
+        std::size_t size = 0;
+        const auto json = Webview::Bench::measure(times, [&](std::size_t) {
+            std::unique_ptr<char, decltype(&g_free)> text(jsc_value_to_json(value.get(), 0), g_free);
+            const std::string message(text.get());
+            size = message.size();
+
+            Webview::JsonBuilder builder;
+            codec.decode(message, builder);
+        });
+
+        const auto walk = Webview::Bench::measure(times, [&](std::size_t) {
+            Webview::JsonBuilder builder;
+            Webview::ValueReader(builder).read(value.get());
+        });
+
+        std::printf("%6s: %zu bytes, stringify and parse %.1f us, read value %.1f us\n", name, size, json / 1e3,
+                    walk / 1e3);
+    }
+}
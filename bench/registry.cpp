@@ -0,0 +1,52 @@
+#include <bench.hpp>
+#include <core/registry.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+int main()
+{
+    constexpr std::size_t times = 4000000;
+
+    for (std::size_t count : {10, 1000, 10000})
+    {
+        //* Functions used to be looked up by their name in a map behind a lock
+        std::mutex mutex;
+        std::map<std::string, std::size_t> byName;
+        Webview::Registry<std::size_t> byId;
+        std::vector<std::string> names;
+
+        for (std::size_t i = 0; count > i; i++)
+        {
+            names.emplace_back("exposedFunction" + std::to_string(i));
+            byName.emplace(names.back(), i);
+            byId.add(i);
+        }
+
+        std::mt19937 random(1);
+        std::vector<std::uint32_t> ids(1 << 16);
+        for (auto &id : ids)
+        {
+            id = static_cast<std::uint32_t>(random() % count);
+        }
+
+        std::size_t sum = 0;
+        const auto map = Webview::Bench::measure(times, [&](std::size_t i) {
+            std::lock_guard lock(mutex);
+            sum += byName.find(names[ids[i & 0xffff]])->second;
+        });
+        const auto registry = Webview::Bench::measure(times, [&](std::size_t i) { sum += *byId.find(ids[i & 0xffff]); });
+
+        std::printf("%5zu functions: map and mutex %.1f ns, registry %.1f ns\n", count, map, registry);
+
+        //* Also keeps the lookups from being optimized away
+        if (sum == 0)
+        {
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#include <atomic>
+#include <chrono>
+#include <core/taskqueue.hpp>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr std::size_t tasks = 1000000;
+
+    //* A deque behind a mutex, which frees and allocates its blocks as tasks pass through
+    class LockedQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+
+      public:
+        void push(std::function<void()> task)
+        {
+            std::lock_guard lock(mutex);
+            tasks.emplace_back(std::move(task));
+        }
+        void drain()
+        {
+            std::deque<std::function<void()>> drained;
+            {
+                std::lock_guard lock(mutex);
+                drained.swap(tasks);
+            }
+
+            for (auto &task : drained)
+            {
+                task();
+            }
+        }
+    };
+
+    //* Producers queue tasks while this thread drains them, like worker threads resolving calls on the main thread
+    template <typename Queue> double run(Queue &queue, std::size_t producers)
+    {
+        const auto tasksPerProducer = tasks / producers;
+
+        std::atomic<std::size_t> ran = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; producers > i; i++)
+        {
+            threads.emplace_back([&queue, &ran, tasksPerProducer] {
+                for (std::size_t task = 0; tasksPerProducer > task; task++)
+                {
+                    queue.push([&ran] { ran.fetch_add(1, std::memory_order_relaxed); });
+                }
+            });
+        }
+
+        while (ran.load(std::memory_order_relaxed) < producers * tasksPerProducer)
+        {
+            queue.drain();
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+               static_cast<double>(producers * tasksPerProducer);
+    }
+} // namespace
+
+int main()
+{
+    std::printf("%u cores\n", std::thread::hardware_concurrency());
+
+    for (const std::size_t producers : {1, 4, 8})
+    {
+        LockedQueue locked;
+        Webview::TaskQueue queue;
+
+        std::printf("%zu producers: mutex and deque %.1f ns/task, task queue %.1f ns/task\n", producers,
+                    run(locked, producers), run(queue, producers));
+    }
+}
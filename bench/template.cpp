@@ -0,0 +1,73 @@
+#include <bench.hpp>
+#include <cstdio>
+#include <javascript/template.hpp>
+#include <regex>
+#include <string>
+
+namespace
+{
+    //* Shaped like the script that calls a javascript function
+    constexpr Webview::Template call = R"js(
+(async () => {
+    let result;
+    try
+    {
+        result = await {1};
+    }
+    catch (error)
+    {
+        window._rpc_post({ "seq": {0}, "error": String(error) });
+        return;
+    }
+
+    window._rpc_post({ "seq": {0}, "result": result });
+})();
+)js";
+
+    //* The script as it was formatted before `Template`, with a regex that is built for every placeholder
+    const std::string callCode = R"js(
+(async () => {
+    let result;
+    try
+    {
+        result = await {1};
+    }
+    catch (error)
+    {
+        window._rpc_post({ "seq": {0}, "error": String(error) });
+        return;
+    }
+
+    window._rpc_post({ "seq": {0}, "result": result });
+})();
+)js";
+} // namespace
+
+int main()
+{
+    constexpr std::size_t times = 1000000;
+
+    const std::string seq = "4711";
+    const std::string function = R"(someFunction("a string", 42, {"key": [1, 2, 3]}))";
+
+    std::string formatted;
+    const auto regex = Webview::Bench::measure(times / 100, [&](std::size_t) {
+        formatted = std::regex_replace(callCode, std::regex(R"(\{0\})"), seq);
+        formatted = std::regex_replace(formatted, std::regex(R"(\{1\})"), function);
+    });
+    const auto regexResult = formatted;
+
+    const auto format = Webview::Bench::measure(times, [&](std::size_t) { formatted = call.format(seq, function); });
+
+    std::string buffer;
+    const auto formatTo = Webview::Bench::measure(times, [&](std::size_t) {
+        buffer.clear();
+        call.formatTo(buffer, seq, function);
+    });
+
+    std::printf("regex_replace: %.1f ns, format: %.1f ns, formatTo into a reused buffer: %.1f ns (%zu bytes)\n", regex,
+                format, formatTo, buffer.size());
+
+    //* Both have to produce the same script for the comparison to mean anything
+    return regexResult == formatted && formatted == buffer ? 0 : 1;
+}
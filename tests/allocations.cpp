@@ -0,0 +1,125 @@
+#include "headless.hpp"
+#include <atomic>
+#include <core/executor.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <new>
+#include <string>
+
+//* Every allocation of the process is counted, the calls below are made from a single thread
+namespace
+{
+    std::atomic<std::size_t> allocations = 0;
+
+    //* Runs `AsyncFunction`s on the calling thread, so that their allocations are counted with the call
+    class InlineExecutor : public Webview::Executor
+    {
+      public:
+        void execute(std::function<void()> func) override
+        {
+            func();
+        }
+    };
+
+    //* The most allocations a call may take, from parsing the message to running the script that resolves it. The
+    //* dispatch itself is not free of allocations yet, the budgets are what a call takes today so that no further ones
+    //* creep in:
+    //*  - 6 are made by nlohmann's parser, which grows the token buffer of its lexer and its own state for every message
+    //*  - 2 are the arguments of the call and the list of the requests in the message
+    //*  - 3 more for an `AsyncFunction`: its cancellation token, its entry in the running calls and the executor task
+    struct Budget
+    {
+        const char *name;
+        std::uint32_t function;
+        double allocations;
+    };
+
+    constexpr std::size_t warmup = 100;
+    constexpr std::size_t calls = 10000;
+} // namespace
+
+void *operator new(std::size_t size)
+{
+    allocations++;
+    if (auto *memory = std::malloc(size ? size : 1))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void *memory, [[maybe_unused]] std::size_t size) noexcept
+{
+    std::free(memory);
+}
+
+int main()
+{
+    Webview::HeadlessWindow window;
+    window.setExecutor(std::make_shared<InlineExecutor>());
+
+    window.expose(Webview::Function("add", [](int a, int b) { return a + b; }));
+    window.expose(
+        Webview::AsyncFunction("addAsync", [](Webview::Promise promise, int a, int b) { promise.resolve(a + b); }));
+
+    const Budget budgets[] = {{"sync", 0, 8}, {"async", 1, 11}};
+
+    std::string message;
+    auto call = [&](std::uint32_t function, std::size_t seq) {
+        message = "[{\"function\":" + std::to_string(function) + ",\"seq\":" + std::to_string(seq) +
+                  ",\"params\":[1,2]}]";
+
+        //* Counted from here on, building the message is not part of the call
+        const auto before = allocations.load();
+        window.handleRawCallRequest(message, 0);
+        window.step();
+
+        return allocations.load() - before;
+    };
+
+    int rtn = 0;
+    std::size_t seq = 0;
+
+    for (const auto &budget : budgets)
+    {
+        //* The first calls grow buffers that later calls reuse
+        for (std::size_t i = 0; warmup > i; i++)
+        {
+            call(budget.function, ++seq);
+        }
+
+        std::size_t total = 0;
+        for (std::size_t i = 0; calls > i; i++)
+        {
+            total += call(budget.function, ++seq);
+        }
+
+        const auto average = static_cast<double>(total) / calls;
+        const auto passed = average <= budget.allocations;
+
+        std::printf("%s call: %.2f allocations (budget %.0f) %s\n", budget.name, average, budget.allocations,
+                    passed ? "ok" : "FAILED");
+
+        if (!passed)
+        {
+            rtn = 1;
+        }
+    }
+
+    //* Makes sure the calls were resolved at all, instead of failing early and cheaply
+    if (window.getScripts() == 0 || window.getLastScript().find("`3`") == std::string::npos)
+    {
+        std::printf("calls were not resolved: %s\n", window.getLastScript().c_str());
+        rtn = 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,68 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <cstdint>
+#include <javascript/function.hpp>
+#include <string>
+
+namespace
+{
+    std::string call(std::uint32_t seq, int a, int b)
+    {
+        return R"([{"function":0,"seq":)" + std::to_string(seq) + R"(,"params":[)" + std::to_string(a) + "," +
+               std::to_string(b) + "]}]";
+    }
+} // namespace
+
+int main()
+{
+    {
+        Webview::HeadlessWindow window;
+        window.expose(Webview::Function("add", [](int a, int b) { return a + b; }));
+
+        //* Calls that are resolved before the next main loop iteration share one script
+        window.handleRawCallRequest(call(1, 1, 2), 0);
+        window.handleRawCallRequest(call(2, 2, 3), 0);
+        window.handleRawCallRequest(call(3, 3, 4), 0);
+        CHECK(window.getScripts() == 0);
+
+        window.step();
+        CHECK(window.getScripts() == 1);
+
+        const auto &script = window.getLastScript();
+        CHECK(script.find("[1,`3`]") != std::string::npos);
+        CHECK(script.find("[2,`5`]") != std::string::npos);
+        CHECK(script.find("[3,`7`]") != std::string::npos);
+
+        const auto stats = window.getBatchStats();
+        CHECK(stats.flushes == 1);
+        CHECK(stats.resolutions == 3);
+        CHECK(stats.largest == 3);
+
+        //* Nothing is run once there is nothing left to resolve
+        window.step();
+        CHECK(window.getScripts() == 1);
+    }
+
+    {
+        Webview::HeadlessWindow window;
+        window.setBatchLimits(2, std::chrono::milliseconds(0));
+        window.expose(Webview::Function("add", [](int a, int b) { return a + b; }));
+
+        //* A full batch is flushed right away, the rest waits for the next main loop iteration
+        window.handleRawCallRequest(call(1, 1, 2), 0);
+        window.handleRawCallRequest(call(2, 2, 3), 0);
+        window.handleRawCallRequest(call(3, 3, 4), 0);
+        CHECK(window.getScripts() == 1);
+
+        window.step();
+        CHECK(window.getScripts() == 2);
+        CHECK(window.getLastScript().find("[3,`7`]") != std::string::npos);
+
+        const auto stats = window.getBatchStats();
+        CHECK(stats.flushes == 2);
+        CHECK(stats.resolutions == 3);
+        CHECK(stats.largest == 2);
+    }
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,57 @@
+#include "check.hpp"
+#include <cstdint>
+#include <json/binary.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    template <typename T> nlohmann::json buffer(const std::vector<T> &values, const char *type)
+    {
+        return {{"_rpc_binary", Webview::Binary::encode(values.data(), values.size() * sizeof(T))}, {"type", type}};
+    }
+
+    template <typename T> bool rejects(const nlohmann::json &j)
+    {
+        try
+        {
+            Webview::Helpers::fromJson<T>(j);
+        }
+        catch (const std::invalid_argument &)
+        {
+            return true;
+        }
+
+        return false;
+    }
+} // namespace
+
+int main()
+{
+    using Webview::Helpers::fromJson;
+
+    //* Buffers of the matching element type arrive as they were sent
+    CHECK((fromJson<std::vector<float>>(buffer<float>({1, 2}, "Float32Array")) == std::vector<float>{1, 2}));
+    CHECK((fromJson<std::vector<double>>(buffer<double>({1, 2}, "Float64Array")) == std::vector<double>{1, 2}));
+    CHECK((fromJson<Webview::TypedArray<std::int16_t>>(buffer<std::int16_t>({-1, 2}, "Int16Array")) ==
+           std::vector<std::int16_t>{-1, 2}));
+
+    //* Bytes can be taken from an ArrayBuffer or an Uint8Array
+    CHECK((fromJson<std::vector<std::uint8_t>>(buffer<std::uint8_t>({1, 255}, "ArrayBuffer")) ==
+           std::vector<std::uint8_t>{1, 255}));
+    CHECK((fromJson<std::vector<std::int8_t>>(buffer<std::uint8_t>({1, 255}, "Uint8Array")) ==
+           std::vector<std::int8_t>{1, -1}));
+
+    //* Buffers of any other element type are rejected instead of reinterpreted
+    CHECK(rejects<std::vector<float>>(buffer<double>({1, 2}, "Float64Array")));
+    CHECK(rejects<std::vector<float>>(buffer<std::int32_t>({1, 2}, "Int32Array")));
+    CHECK(rejects<std::vector<int>>(buffer<std::uint8_t>({1, 2, 3, 4}, "Uint8Array")));
+    CHECK(rejects<std::vector<int>>(buffer<std::uint32_t>({1, 2}, "Uint32Array")));
+    CHECK(rejects<std::vector<std::uint16_t>>(buffer<std::uint8_t>({1, 2}, "ArrayBuffer")));
+    CHECK(rejects<std::vector<std::uint8_t>>(buffer<std::uint16_t>({1, 2}, "Uint16Array")));
+
+    //* Plain arrays are still accepted
+    CHECK((fromJson<std::vector<float>>(nlohmann::json::array({1, 2})) == std::vector<float>{1, 2}));
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,95 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <chrono>
+#include <cstdint>
+#include <javascript/function.hpp>
+#include <json/codec.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+    std::string call(std::uint32_t function, std::uint32_t seq, const std::string &param)
+    {
+        return R"([{"function":)" + std::to_string(function) + R"(,"seq":)" + std::to_string(seq) + R"(,"params":[)" +
+               param + "]}]";
+    }
+} // namespace
+
+int main()
+{
+    Webview::HeadlessWindow window;
+
+    std::size_t runs = 0;
+    auto lookup = [&runs](const nlohmann::json &value) {
+        runs++;
+        return value;
+    };
+
+    Webview::ExposeOptions options;
+    options.cacheSize = 2;
+    window.expose(Webview::Function("lookup", lookup), options);
+
+    options.cacheTtl = std::chrono::milliseconds(10);
+    window.expose(Webview::Function("expiring", lookup), options);
+
+    std::uint32_t seq = 0;
+    auto lookupOf = [&](std::uint32_t function, const std::string &param) {
+        window.handleRawCallRequest(call(function, ++seq, param), 0);
+        window.step();
+        return window.getLastScript();
+    };
+
+    {
+        //* Repeated calls are answered from the cache, equal objects hit regardless of the order of their keys
+        const auto first = lookupOf(0, R"({"a":1,"b":2})");
+        const auto second = lookupOf(0, R"({"b":2,"a":1})");
+        CHECK(runs == 1);
+        CHECK(first.substr(first.find(',')) == second.substr(second.find(',')));
+
+        const auto stats = window.getCacheStats("lookup");
+        CHECK(stats.size == 1);
+        CHECK(stats.hits == 1);
+        CHECK(stats.misses == 1);
+    }
+
+    {
+        //* The least recently used result is evicted once the cache is full
+        lookupOf(0, "1");
+        lookupOf(0, R"({"a":1,"b":2})");
+        lookupOf(0, "2");
+        CHECK(runs == 3);
+        CHECK(window.getCacheStats("lookup").evictions == 1);
+
+        lookupOf(0, R"({"a":1,"b":2})");
+        CHECK(runs == 3);
+        lookupOf(0, "1");
+        CHECK(runs == 4);
+    }
+
+    {
+        //* Results expire after their time to live
+        lookupOf(1, "1");
+        lookupOf(1, "1");
+        CHECK(runs == 5);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        lookupOf(1, "1");
+        CHECK(runs == 6);
+    }
+
+    {
+        //* Results that were encoded with another codec are dropped along with it
+        window.setCodec(std::make_shared<Webview::JsonCodec>());
+        CHECK(window.getCacheStats("lookup").size == 0);
+
+        lookupOf(0, "2");
+        CHECK(runs == 7);
+    }
+
+    //* Functions without a cache are not counted
+    CHECK(window.getCacheStats("unknown").hits == 0);
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,89 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+
+int main()
+{
+    auto executor = std::make_shared<Webview::ManualExecutor>();
+
+    Webview::HeadlessWindow window;
+    window.setExecutor(executor);
+
+    std::size_t runs = 0;
+    std::optional<Webview::Promise> pending;
+    window.expose(Webview::AsyncFunction("wait", [&](Webview::Promise promise) {
+        runs++;
+        pending.emplace(promise);
+    }));
+
+    {
+        //* A running call observes the cancellation through its promise
+        window.handleRawCallRequest(R"([{"function":0,"seq":1,"params":[]}])", 0);
+        executor->runAll();
+        CHECK(runs == 1);
+        CHECK(pending && !pending->isCancelled());
+
+        bool notified = false;
+        pending->getToken()->onCancel([&notified] { notified = true; });
+
+        window.handleRawCallRequest(R"([{"seq":1,"cancel":true}])", 0);
+        CHECK(pending->isCancelled());
+        CHECK(notified);
+
+        pending->resolve(true);
+        pending.reset();
+        window.step();
+    }
+
+    {
+        //* A call that is cancelled before it runs, also within the message that made it, is never run
+        window.handleRawCallRequest(R"([{"function":0,"seq":2,"params":[]}])", 0);
+        window.handleRawCallRequest(R"([{"seq":2,"cancel":true}])", 0);
+        window.handleRawCallRequest(R"([{"function":0,"seq":3,"params":[]},{"seq":3,"cancel":true}])", 0);
+        executor->runAll();
+        window.step();
+
+        CHECK(runs == 1);
+        CHECK(!pending);
+        CHECK(window.getLastScript().find("[2,`null`]") != std::string::npos);
+        CHECK(window.getLastScript().find("[3,`null`]") != std::string::npos);
+    }
+
+    {
+        //* Cancelling a call that is not running, e.g. one that already finished, does nothing
+        window.handleRawCallRequest(R"([{"seq":1,"cancel":true},{"seq":42,"cancel":true}])", 0);
+        CHECK(executor->size() == 0);
+    }
+
+    {
+        //* Navigating away cancels the calls of the page, their results are dropped
+        window.handleRawCallRequest(R"([{"function":0,"seq":4,"params":[]}])", 0);
+        executor->runAll();
+        window.step();
+
+        const auto scripts = window.getScripts();
+        window.abandonCalls();
+        CHECK(pending->isCancelled());
+
+        pending->resolve(true);
+        pending.reset();
+        window.step();
+        CHECK(window.getScripts() == scripts);
+
+        //* Calls of the next page are resolved again, even if their sequence is one of the previous page
+        window.receiveMessage(R"([{"function":0,"seq":4,"params":[]}])");
+        executor->runAll();
+        CHECK(pending && !pending->isCancelled());
+
+        pending->resolve(true);
+        window.step();
+        CHECK(window.getScripts() == scripts + 1);
+        CHECK(window.getLastScript().find("[4,`true`]") != std::string::npos);
+    }
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdio>
+
+namespace Webview::Test
+{
+    inline int failures = 0;
+
+    /// \effects Reports the given check if it failed
+    inline void check(bool passed, const char *condition, int line)
+    {
+        if (!passed)
+        {
+            std::printf("line %d: %s failed\n", line, condition);
+            failures++;
+        }
+    }
+
+    /// \returns The exit code of a test, which fails if any check did
+    inline int result()
+    {
+        return failures ? 1 : 0;
+    }
+} // namespace Webview::Test
+
+#define CHECK(condition) Webview::Test::check(static_cast<bool>(condition), #condition, __LINE__)
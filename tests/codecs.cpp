@@ -0,0 +1,95 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <cstdint>
+#include <javascript/function.hpp>
+#include <json/binary.hpp>
+#include <json/builder.hpp>
+#include <json/codec.hpp>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace
+{
+    //* Messages from javascript arrive the way results are sent to it, binary ones as base64
+    std::string send(const Webview::Codec &codec, const nlohmann::json &value)
+    {
+        const auto encoded = codec.encode(value);
+        return codec.isBinary() ? Webview::Binary::encode(encoded.data(), encoded.size()) : encoded;
+    }
+
+    bool roundTrips(const Webview::Codec &codec, const nlohmann::json &value)
+    {
+        Webview::JsonBuilder builder;
+        return codec.decode(send(codec, value), builder) && builder.done() && builder.get() == value;
+    }
+} // namespace
+
+int main()
+{
+    const std::pair<const char *, std::shared_ptr<Webview::Codec>> codecs[] = {
+        {"json", std::make_shared<Webview::JsonCodec>()},
+        {"cbor", std::make_shared<Webview::CborCodec>()},
+        {"msgpack", std::make_shared<Webview::MessagePackCodec>()},
+    };
+
+    nlohmann::json records;
+    for (int i = 0; 1000 > i; i++)
+    {
+        records.push_back({{"id", i}, {"score", i * 0.25}, {"label", "item " + std::to_string(i)}});
+    }
+
+    //* Integers at the boundaries of the encodings' size classes, floats, text and nesting
+    const nlohmann::json values[] = {
+        nullptr,
+        true,
+        0,
+        23,
+        24,
+        255,
+        256,
+        65535,
+        65536,
+        -1,
+        -24,
+        -25,
+        -129,
+        std::numeric_limits<std::int32_t>::min(),
+        std::numeric_limits<std::uint32_t>::max(),
+        std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::uint64_t>::max(),
+        0.5,
+        -1e300,
+        "",
+        "\xc3\xa4\xe2\x82\xac\xf0\x9f\x98\x80",
+        std::string(100000, 'a'),
+        nlohmann::json::array(),
+        nlohmann::json::object(),
+        {{"nested", {{"array", {1, "two", 3.5, nullptr}}}}},
+        records,
+    };
+
+    for (const auto &[name, codec] : codecs)
+    {
+        for (const auto &value : values)
+        {
+            if (!roundTrips(*codec, value))
+            {
+                std::printf("%s: %.60s does not round trip\n", name, value.dump().c_str());
+                Webview::Test::failures++;
+            }
+        }
+
+        //* A call that is sent in the codec's encoding is resolved in it as well
+        Webview::HeadlessWindow window;
+        window.setCodec(codec);
+        window.expose(Webview::Function("add", [](int a, int b) { return a + b; }));
+
+        window.receiveMessage(send(*codec, nlohmann::json::array({{{"function", 0}, {"seq", 1}, {"params", {1, 2}}}})));
+        window.step();
+
+        CHECK(window.getLastScript().find("[1,`" + send(*codec, 3) + "`]") != std::string::npos);
+    }
+
+    return Webview::Test::result();
+}
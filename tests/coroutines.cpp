@@ -0,0 +1,76 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <core/executor.hpp>
+#include <coroutine>
+#include <javascript/coroutine.hpp>
+#include <javascript/function.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    class InlineExecutor : public Webview::Executor
+    {
+      public:
+        void execute(std::function<void()> func) override
+        {
+            func();
+        }
+    };
+
+    //* Suspends the awaiting coroutine until the test resumes it
+    std::coroutine_handle<> suspended;
+    struct Suspend
+    {
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> coroutine) noexcept
+        {
+            suspended = coroutine;
+        }
+        void await_resume() const noexcept {}
+    };
+} // namespace
+
+int main()
+{
+    Webview::HeadlessWindow window;
+    window.setExecutor(std::make_shared<InlineExecutor>());
+
+    std::shared_ptr<Webview::CancellationToken> token;
+
+    window.expose(Webview::AsyncFunction("fails", []() -> Webview::Task<int> {
+        co_await Suspend{};
+        throw std::runtime_error("broken");
+    }));
+    window.expose(Webview::AsyncFunction(
+        "watches", [&token](std::shared_ptr<Webview::CancellationToken> cancellation, int value) -> Webview::Task<int> {
+            token = cancellation;
+            co_await Suspend{};
+            co_return cancellation->isCancelled() ? -1 : value;
+        }));
+
+    //* A coroutine that throws rejects its call with the message of the exception
+    window.handleRawCallRequest(R"([{"function":0,"seq":1,"params":[]}])", 0);
+    suspended.resume();
+    window.step();
+
+    CHECK(window.getLastScript().find("[1,null,null,null,`\"broken\"`]") != std::string::npos);
+
+    //* A coroutine that takes a token sees the call being cancelled, and still takes its other arguments
+    window.handleRawCallRequest(R"([{"function":1,"seq":2,"params":[5]}])", 0);
+    CHECK(token && !token->isCancelled());
+
+    window.handleRawCallRequest(R"([{"seq":2,"cancel":true}])", 0);
+    CHECK(token && token->isCancelled());
+
+    suspended.resume();
+    window.step();
+
+    CHECK(window.getLastScript().find("[2,`-1`]") != std::string::npos);
+
+    return Webview::Test::result();
+}
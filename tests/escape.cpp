@@ -0,0 +1,48 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include "legacy.hpp"
+#include <cstddef>
+#include <random>
+#include <string>
+
+int main()
+{
+    Webview::HeadlessWindow window;
+
+    //* Made of the characters that form the sequences to escape, so that they occur in every combination
+    constexpr char alphabet[] = {'\\', '\\', '"', 'n', 't', 'a'};
+    constexpr std::size_t inputs = 200000;
+
+    std::mt19937 random(4711);
+    std::uniform_int_distribution<std::size_t> length(0, 16);
+    std::uniform_int_distribution<std::size_t> character(0, sizeof(alphabet) - 1);
+
+    std::string code;
+    std::string buffer;
+    std::size_t mismatches = 0;
+
+    for (std::size_t i = 0; inputs > i; i++)
+    {
+        code.resize(length(random));
+        for (auto &c : code)
+        {
+            c = alphabet[character(random)];
+        }
+
+        if (window.formatCode(code, buffer) != Webview::Legacy::formatCode(code))
+        {
+            if (mismatches++ == 0)
+            {
+                std::printf("first mismatch: %s\n", code.c_str());
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+
+    //* Code without anything to escape is returned as it is
+    const std::string plain = R"(window._rpc_resolve([[1,`"text"`]]);)";
+    CHECK(&window.formatCode(plain, buffer) == &plain);
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,46 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <javascript/function.hpp>
+#include <stdexcept>
+#include <string>
+
+int main()
+{
+    Webview::HeadlessWindow window;
+    window.expose(Webview::Function("add", [](int a, int b) { return a + b; }));
+    window.expose(Webview::Function("check", [](int value) {
+        if (value < 0)
+        {
+            throw std::runtime_error("negative");
+        }
+        return value;
+    }));
+
+    //* The calls that javascript made in the same microtask arrive as one message
+    window.handleRawCallRequest(R"([
+        {"function":0,"seq":1,"params":[1,2]},
+        {"function":1,"seq":2,"params":[-1]},
+        {"function":1,"seq":3,"params":[4]},
+        {"function":7,"seq":4,"params":[]},
+        {"function":0,"seq":5,"params":["text",2]}
+    ])",
+                                0);
+    window.step();
+
+    //* Each of them is resolved, a call that fails only rejects itself
+    const auto &script = window.getLastScript();
+    CHECK(window.getScripts() == 1);
+    CHECK(script.find("[1,`3`]") != std::string::npos);
+    CHECK(script.find(R"([2,null,null,null,`"negative"`])") != std::string::npos);
+    CHECK(script.find("[3,`4`]") != std::string::npos);
+    CHECK(script.find(R"([4,null,null,null,`"There is no function with the id 7"`])") != std::string::npos);
+    CHECK(script.find("[5,null,null,null,") != std::string::npos);
+    CHECK(window.getBatchStats().resolutions == 5);
+
+    //* A message that can't be parsed is dropped as a whole
+    window.handleRawCallRequest(R"([{"function":0,"seq":6,"params":[1,2]},)", 0);
+    window.step();
+    CHECK(window.getScripts() == 1);
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <core/basewindow.hpp>
+#include <core/executor.hpp>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Webview
+{
+    //* A window without a platform. Scripts it is asked to run are only counted, and dispatched tasks wait for
+    //* `step` to run them on the calling thread, which then acts as the main thread.
+    class HeadlessWindow : public BaseWindow
+    {
+        std::mutex tasksMutex;
+        std::condition_variable tasksChanged;
+        std::vector<std::function<void()>> tasks;
+        std::vector<std::function<void()>> running; //* Swapped with the tasks, so that neither has to grow again
+
+        bool done = false;
+
+      protected:
+        std::size_t scripts = 0;
+        std::string lastScript;
+
+        void dispatch(std::function<void()> func, [[maybe_unused]] std::chrono::milliseconds delay) override
+        {
+            //* Delays are not waited for, tasks run on the next step
+            {
+                std::lock_guard lock(tasksMutex);
+                tasks.emplace_back(std::move(func));
+            }
+            tasksChanged.notify_one();
+        }
+
+      public:
+        HeadlessWindow() : BaseWindow("", 0, 0) {}
+        ~HeadlessWindow()
+        {
+            shutdown();
+        }
+
+        /// \effects Runs the tasks that were dispatched so far
+        /// \returns Whether or not there were any
+        bool step()
+        {
+            {
+                std::lock_guard lock(tasksMutex);
+                running.swap(tasks);
+            }
+
+            for (auto &task : running)
+            {
+                task();
+            }
+
+            const auto ran = !running.empty();
+            running.clear();
+
+            return ran;
+        }
+
+        /// \effects Runs dispatched tasks until `exit` is called
+        void run() override
+        {
+            while (true)
+            {
+                {
+                    std::unique_lock lock(tasksMutex);
+                    tasksChanged.wait(lock, [this] { return done || !tasks.empty(); });
+
+                    if (done)
+                    {
+                        return;
+                    }
+                }
+
+                step();
+            }
+        }
+        void exit() override
+        {
+            {
+                std::lock_guard lock(tasksMutex);
+                done = true;
+            }
+            tasksChanged.notify_one();
+        }
+
+        void enableDevTools([[maybe_unused]] bool state) override {}
+
+        void runCode(const std::string &code) override
+        {
+            scripts++;
+            lastScript.assign(code);
+        }
+        void injectCode([[maybe_unused]] const std::string &code) override {}
+
+        /// \returns How many scripts were run so far
+        std::size_t getScripts() const
+        {
+            return scripts;
+        }
+        /// \returns The script that was run last
+        const std::string &getLastScript() const
+        {
+            return lastScript;
+        }
+
+        using BaseWindow::abandonCalls;
+        using BaseWindow::formatCode;
+        using BaseWindow::getCodec;
+        using BaseWindow::handleRawCallRequest;
+        using BaseWindow::receiveMessage;
+    };
+
+    //* Holds the tasks it is given until they are run explicitly, so that a test decides when calls run
+    class ManualExecutor : public Executor
+    {
+        std::deque<std::function<void()>> tasks;
+
+      public:
+        void execute(std::function<void()> func) override
+        {
+            tasks.emplace_back(std::move(func));
+        }
+
+        /// \returns How many tasks are waiting to be run
+        std::size_t size() const
+        {
+            return tasks.size();
+        }
+
+        /// \effects Runs the oldest task
+        void runNext()
+        {
+            auto task = std::move(tasks.front());
+            tasks.pop_front();
+            task();
+        }
+        /// \effects Runs tasks until there are none left, including the ones that are queued meanwhile
+        void runAll()
+        {
+            while (!tasks.empty())
+            {
+                runNext();
+            }
+        }
+    };
+} // namespace Webview
@@ -0,0 +1,18 @@
+#pragma once
+#include <regex>
+#include <string>
+
+namespace Webview::Legacy
+{
+    //* The implementations that were replaced, kept to check the new ones against and to compare their speed
+
+    /// \returns The given code escaped with the three regex passes `formatCode` used to make
+    inline std::string formatCode(const std::string &code)
+    {
+        auto formattedCode = std::regex_replace(code, std::regex(R"rgx(\\")rgx"), R"(\\\")");
+        formattedCode = std::regex_replace(formattedCode, std::regex(R"rgx(\\n)rgx"), R"(\\n)");
+        formattedCode = std::regex_replace(formattedCode, std::regex(R"rgx(\\t)rgx"), R"(\\t)");
+
+        return formattedCode;
+    }
+} // namespace Webview::Legacy
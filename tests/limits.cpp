@@ -0,0 +1,118 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <cstdint>
+#include <deque>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <memory>
+#include <string>
+
+namespace
+{
+    std::string call(std::uint32_t function, std::uint32_t seq)
+    {
+        return R"([{"function":)" + std::to_string(function) + R"(,"seq":)" + std::to_string(seq) +
+               R"(,"params":[]}])";
+    }
+
+    bool isRejected(const std::string &script, std::uint32_t seq)
+    {
+        return script.find("[" + std::to_string(seq) + ",null,null,null,") != std::string::npos;
+    }
+} // namespace
+
+int main()
+{
+    auto executor = std::make_shared<Webview::ManualExecutor>();
+
+    Webview::HeadlessWindow window;
+    window.setExecutor(executor);
+
+    std::deque<Webview::Promise> promises;
+    auto wait = [&promises](Webview::Promise promise) { promises.emplace_back(promise); };
+
+    auto resolveAll = [&] {
+        //* Resolving a call may start a waiting one, whose promise is only added once it ran
+        while (executor->runAll(), !promises.empty())
+        {
+            auto promise = promises.front();
+            promises.pop_front();
+            promise.resolve(true);
+        }
+        window.step();
+    };
+
+    Webview::ExposeOptions options;
+    options.maxConcurrency = 1;
+    options.maxQueued = 1;
+
+    options.policy = Webview::QueuePolicy::Queue;
+    window.expose(Webview::AsyncFunction("queue", wait), options);
+    options.policy = Webview::QueuePolicy::Reject;
+    window.expose(Webview::AsyncFunction("reject", wait), options);
+    options.policy = Webview::QueuePolicy::DropOldest;
+    window.expose(Webview::AsyncFunction("dropOldest", wait), options);
+
+    {
+        //* Calls over the limit wait for a free slot, new ones are rejected once the queue is full
+        window.handleRawCallRequest(call(0, 1), 0);
+        window.handleRawCallRequest(call(0, 2), 0);
+        window.handleRawCallRequest(call(0, 3), 0);
+        executor->runAll();
+        CHECK(promises.size() == 1);
+
+        auto stats = window.getConcurrencyStats("queue");
+        CHECK(stats.running == 1);
+        CHECK(stats.waiting == 1);
+        CHECK(stats.queued == 1);
+        CHECK(stats.rejected == 1);
+
+        resolveAll();
+        CHECK(window.getLastScript().find("[1,`true`]") != std::string::npos);
+        CHECK(window.getLastScript().find("[2,`true`]") != std::string::npos);
+        CHECK(isRejected(window.getLastScript(), 3));
+
+        stats = window.getConcurrencyStats("queue");
+        CHECK(stats.running == 0);
+        CHECK(stats.waiting == 0);
+    }
+
+    {
+        //* Calls over the limit are rejected right away
+        window.handleRawCallRequest(call(1, 4), 0);
+        window.handleRawCallRequest(call(1, 5), 0);
+
+        const auto stats = window.getConcurrencyStats("reject");
+        CHECK(stats.running == 1);
+        CHECK(stats.waiting == 0);
+        CHECK(stats.rejected == 1);
+
+        resolveAll();
+        CHECK(window.getLastScript().find("[4,`true`]") != std::string::npos);
+        CHECK(isRejected(window.getLastScript(), 5));
+    }
+
+    {
+        //* Once the queue is full, the oldest waiting call makes room for the new one
+        window.handleRawCallRequest(call(2, 6), 0);
+        window.handleRawCallRequest(call(2, 7), 0);
+        window.handleRawCallRequest(call(2, 8), 0);
+
+        const auto stats = window.getConcurrencyStats("dropOldest");
+        CHECK(stats.running == 1);
+        CHECK(stats.waiting == 1);
+        CHECK(stats.queued == 2);
+        CHECK(stats.dropped == 1);
+        CHECK(stats.rejected == 0);
+
+        resolveAll();
+        CHECK(window.getLastScript().find("[6,`true`]") != std::string::npos);
+        CHECK(isRejected(window.getLastScript(), 7));
+        CHECK(window.getLastScript().find("[8,`true`]") != std::string::npos);
+    }
+
+    //* Functions without a limit are not counted
+    CHECK(window.getConcurrencyStats("unknown").running == 0);
+
+    return Webview::Test::result();
+}
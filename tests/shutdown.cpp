@@ -0,0 +1,68 @@
+#include "headless.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace
+{
+    //* Notes whether a script was run once the window started to shut down, which must not happen
+    class ClosingWindow : public Webview::HeadlessWindow
+    {
+        std::atomic<bool> &late;
+
+      public:
+        explicit ClosingWindow(std::atomic<bool> &late) : late(late) {}
+
+        void runCode(const std::string &code) override
+        {
+            if (closing)
+            {
+                late = true;
+            }
+
+            HeadlessWindow::runCode(code);
+        }
+    };
+} // namespace
+
+int main()
+{
+    std::atomic<bool> late = false;
+    std::atomic<std::size_t> finished = 0;
+
+    {
+        auto window = std::make_unique<ClosingWindow>(late);
+        window->setWorkerCount(1);
+        window->setBatchLimits(1, std::chrono::milliseconds(0));
+
+        window->expose(Webview::AsyncFunction("slow", [&finished](Webview::Promise promise) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            finished++;
+            promise.resolve(true);
+        }));
+
+        //* The second call is still queued once the window is destroyed, the first one is running
+        window->handleRawCallRequest(R"([{"function":0,"seq":1,"params":[]},{"function":0,"seq":2,"params":[]}])", 0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    int rtn = 0;
+
+    if (finished != 2)
+    {
+        std::printf("%zu of 2 calls finished before the window was gone\n", finished.load());
+        rtn = 1;
+    }
+    if (late)
+    {
+        std::printf("a call was resolved while the window shut down\n");
+        rtn = 1;
+    }
+
+    return rtn;
+}
@@ -0,0 +1,100 @@
+#include "check.hpp"
+#include "headless.hpp"
+#include <cstdint>
+#include <deque>
+#include <javascript/function.hpp>
+#include <javascript/promise.hpp>
+#include <memory>
+#include <string>
+
+namespace
+{
+    std::string call(std::uint32_t seq, int param)
+    {
+        return R"([{"function":0,"seq":)" + std::to_string(seq) + R"(,"params":[)" + std::to_string(param) + "]}]";
+    }
+} // namespace
+
+int main()
+{
+    auto executor = std::make_shared<Webview::ManualExecutor>();
+
+    Webview::HeadlessWindow window;
+    window.setExecutor(executor);
+
+    std::deque<std::pair<Webview::Promise, int>> runs;
+
+    Webview::ExposeOptions options;
+    options.singleFlight = true;
+    window.expose(Webview::AsyncFunction(
+                      "fetch", [&runs](Webview::Promise promise, int value) { runs.emplace_back(promise, value); }),
+                  options);
+
+    {
+        //* Identical calls that overlap share one run and are resolved with its result
+        window.handleRawCallRequest(call(1, 10), 0);
+        window.handleRawCallRequest(call(2, 10), 0);
+        window.handleRawCallRequest(call(3, 20), 0);
+        executor->runAll();
+        CHECK(runs.size() == 2);
+
+        for (const auto &[promise, value] : runs)
+        {
+            promise.resolve(value * 2);
+        }
+        runs.clear();
+        window.step();
+
+        const auto &script = window.getLastScript();
+        CHECK(script.find("[1,`20`]") != std::string::npos);
+        CHECK(script.find("[2,`20`]") != std::string::npos);
+        CHECK(script.find("[3,`40`]") != std::string::npos);
+    }
+
+    {
+        //* Once a run is resolved, the next identical call starts a run of its own
+        window.handleRawCallRequest(call(4, 10), 0);
+        executor->runAll();
+        CHECK(runs.size() == 1);
+
+        runs.front().first.resolve(0);
+        runs.clear();
+        window.step();
+    }
+
+    {
+        //* The run is only cancelled once neither the call that started it nor any that joined it waits anymore
+        window.handleRawCallRequest(call(5, 10), 0);
+        window.handleRawCallRequest(call(6, 10), 0);
+        executor->runAll();
+        CHECK(runs.size() == 1);
+
+        const auto &promise = runs.front().first;
+        window.handleRawCallRequest(R"([{"seq":5,"cancel":true}])", 0);
+        CHECK(!promise.isCancelled());
+        window.handleRawCallRequest(R"([{"seq":6,"cancel":true}])", 0);
+        CHECK(promise.isCancelled());
+
+        promise.resolve(nullptr);
+        runs.clear();
+        window.step();
+    }
+
+    {
+        //* A run that fails rejects every call that joined it
+        window.handleRawCallRequest(call(7, 10), 0);
+        window.handleRawCallRequest(call(8, 10), 0);
+        executor->runAll();
+        CHECK(runs.size() == 1);
+
+        runs.front().first.reject("failed");
+        runs.clear();
+        window.step();
+
+        const auto &script = window.getLastScript();
+        CHECK(script.find(R"([7,null,null,null,`"failed"`])") != std::string::npos);
+        CHECK(script.find(R"([8,null,null,null,`"failed"`])") != std::string::npos);
+    }
+
+    return Webview::Test::result();
+}
@@ -0,0 +1,118 @@
+#include "check.hpp"
+#include <atomic>
+#include <core/taskqueue.hpp>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    //* Tasks run in the order they were queued, and only the first one after a drain wakes the consumer
+    {
+        Webview::TaskQueue queue;
+        std::vector<int> ran;
+
+        CHECK(queue.push([&ran] { ran.push_back(0); }));
+        for (int i = 1; 1000 > i; i++)
+        {
+            CHECK(!queue.push([&ran, i] { ran.push_back(i); }));
+        }
+
+        queue.drain();
+
+        CHECK(ran.size() == 1000);
+        for (int i = 0; static_cast<int>(ran.size()) > i; i++)
+        {
+            CHECK(ran[i] == i);
+        }
+    }
+
+    //* A task that is queued while the consumer drains wakes it again and waits for the next drain
+    {
+        Webview::TaskQueue queue;
+        bool woken = false;
+        bool ranAgain = false;
+
+        queue.push([&] { woken = queue.push([&ranAgain] { ranAgain = true; }); });
+        queue.drain();
+
+        CHECK(woken);
+        CHECK(!ranAgain);
+
+        queue.drain();
+        CHECK(ranAgain);
+    }
+
+    //* A task that throws does not make the tasks before it run again
+    {
+        Webview::TaskQueue queue;
+        int ran = 0;
+
+        queue.push([&ran] { ran++; });
+        queue.push([] { throw std::runtime_error("broken"); });
+
+        try
+        {
+            queue.drain();
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+
+        queue.drain();
+        CHECK(ran == 1);
+    }
+
+    //* Many producers at once, the tasks of every producer run in the order it queued them
+    {
+        constexpr std::size_t producers = 6;
+        constexpr std::size_t tasksPerProducer = 100000;
+
+        Webview::TaskQueue queue;
+        std::vector<std::size_t> next(producers, 0); //* Only touched by the tasks, which run on this thread
+        std::size_t outOfOrder = 0;
+        std::size_t ran = 0;
+
+        std::atomic<std::size_t> wakeups = 0;
+        std::vector<std::thread> threads;
+
+        for (std::size_t producer = 0; producers > producer; producer++)
+        {
+            threads.emplace_back([&, producer] {
+                for (std::size_t task = 0; tasksPerProducer > task; task++)
+                {
+                    const auto wake = queue.push([&, producer, task] {
+                        if (next[producer]++ != task)
+                        {
+                            outOfOrder++;
+                        }
+                        ran++;
+                    });
+
+                    if (wake)
+                    {
+                        wakeups++;
+                    }
+                }
+            });
+        }
+
+        while (ran < producers * tasksPerProducer)
+        {
+            queue.drain();
+            std::this_thread::yield();
+        }
+
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        CHECK(ran == producers * tasksPerProducer);
+        CHECK(outOfOrder == 0);
+        CHECK(wakeups > 0);
+    }
+
+    return Webview::Test::result();
+}
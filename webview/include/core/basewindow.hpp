@@ -1,12 +1,28 @@
 #pragma once
+#include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <optional>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "cache.hpp"
+#include "executor.hpp"
+#include "registry.hpp"
+#include "serialexecutor.hpp"
 #include "resource.hpp"
+#include "threadpool.hpp"
+#include <javascript/call.hpp>
+#include <javascript/cancellation.hpp>
 #include <javascript/function.hpp>
+#include <javascript/template.hpp>
+#include <json/codec.hpp>
 
 #if __has_include(<embedded/include.hpp>)
 #define WEBVIEW_EMBEDDED
@@ -15,10 +31,70 @@
 
 namespace Webview
 {
+    enum class QueuePolicy
+    {
+        Queue,      //* Calls over the limit wait for a free slot, new calls are rejected once the queue is full
+        Reject,     //* Calls over the limit are rejected right away
+        DropOldest, //* Calls over the limit wait for a free slot, the oldest one is rejected once the queue is full
+    };
+
+    struct ExposeOptions
+    {
+        std::shared_ptr<Executor> executor; //* Runs the function if it is an `AsyncFunction`, overrides the window's
+        std::size_t maxConcurrency = 0;     //* Most calls of an `AsyncFunction` that may run at once, `0` is unlimited
+        std::size_t maxQueued = 0;          //* Most calls that may wait for a free slot, `0` is unlimited
+        QueuePolicy policy = QueuePolicy::Queue;
+
+        std::size_t cacheSize = 0; //* Most results of a pure `Function` that are remembered, `0` disables caching
+        std::chrono::milliseconds cacheTtl{0}; //* How long results are remembered, `0` is until they are evicted
+
+        bool singleFlight = false; //* Whether identical calls of an `AsyncFunction` that overlap share one run
+    };
+
+    struct ConcurrencyStats
+    {
+        std::size_t running;  //* Calls that are running right now
+        std::size_t waiting;  //* Calls that wait for a free slot right now
+        std::size_t queued;   //* Calls that had to wait for a free slot
+        std::size_t rejected; //* Calls that were rejected because the limits were reached
+        std::size_t dropped;  //* Calls that were rejected after waiting, in favour of newer ones
+    };
+
+    struct BatchStats
+    {
+        std::size_t flushes;     //* Scripts that were run to resolve pending calls
+        std::size_t resolutions; //* Calls that were resolved by these scripts
+        std::size_t largest;     //* Most calls resolved by a single script
+    };
+
+    struct CallStats
+    {
+        std::size_t pending;   //* Javascript calls that were not responded to yet
+        std::size_t timedOut;  //* Calls that failed because javascript did not respond before their deadline
+        std::size_t abandoned; //* Calls that failed because the page navigated away
+        std::size_t failed;    //* Calls that failed because the javascript function threw
+    };
+
+    //* Why a `Function` runs on the executor instead of the main thread
+    struct Promotion
+    {
+        std::string name;
+        std::chrono::nanoseconds took;    //* How long the call took that exceeded the budget
+        std::chrono::nanoseconds budget;  //* The budget it exceeded
+        std::chrono::nanoseconds average; //* How long the calls that ran on the main thread took on average
+        std::size_t calls;                //* Calls that ran on the main thread, including the one that was too slow
+    };
+
     class Promise;
+#if defined(WEBVIEWPP_COROUTINES)
+    template <typename T> class CallAwaitable;
+#endif
     class BaseWindow
     {
         friend class Promise;
+#if defined(WEBVIEWPP_COROUTINES)
+        template <typename T> friend class CallAwaitable;
+#endif
 
       protected:
         std::size_t width;
@@ -36,16 +112,123 @@ namespace Webview
         std::function<void(std::size_t, std::size_t)> resizeCallback;
 
         static const std::string setupRpc;
-        static const std::string resolveCall;
-        static const std::string resolveNativeCall;
-        static const std::string resolveNativeFunction;
-        static const std::string callbackFunctionDefinition;
+        static const Template resolveCall;
+        static const Template resolveBinaryCall;
+        static const Template resolveHandleCall;
+        static const Template rejectCall;
+        static const std::string resolveBatchBegin;
+        static const std::string resolveBatchEnd;
+        static const Template resolveNativeCall;
+        static const Template callbackFunctionDefinition;
+        static const Template cachedFunctionDefinition;
+
+        using MessageReader = std::function<bool(nlohmann::json_sax<nlohmann::json> &)>;
+
+        struct Limiter
+        {
+            std::mutex mutex;
+            std::deque<std::pair<CallId, std::function<void()>>> waiting;
+            ConcurrencyStats stats{};
+        };
+
+        struct Timing
+        {
+            std::mutex mutex;
+            std::size_t calls = 0;
+            std::chrono::nanoseconds total{0};
+            std::optional<Promotion> promotion;
+            std::atomic<bool> promoted = false; //* Set once there is a promotion, read without the lock
+        };
+
+        struct Exposed
+        {
+            std::shared_ptr<Function> function;
+            const AsyncFunction *asyncFunction; //* The same function, only set if it is async
+            ExposeOptions options;
+            std::shared_ptr<Limiter> limiter; //* Only set if the concurrency of the function is limited
+            std::shared_ptr<ResultCache> cache;
+            std::shared_ptr<Timing> timing; //* Only set if the function is not async
+        };
+
+        struct EncodedResult
+        {
+            std::string value;
+            bool binary; //* Whether or not the value is a binary marker, which is sent as it is
+            bool parked; //* Whether or not the value is the handle of a parked result
+        };
+
+        struct Flight
+        {
+            std::string key;
+            std::vector<CallId> waiters;        //* Calls that joined the flight and are resolved with its result
+            bool cancelled = false;             //* Whether the call that started the flight was cancelled
+        };
+
+        struct Parked
+        {
+            std::string payload;
+            std::uint32_t epoch; //* The page that may fetch the result
+        };
+
+        struct Running
+        {
+            std::shared_ptr<CancellationToken> token;
+            std::shared_ptr<Limiter> limiter; //* Its slot is freed once the call is resolved
+        };
 
         std::mutex functionsMutex;
-        std::map<std::string, std::shared_ptr<Function>> functions;
+        std::map<std::string, std::uint32_t> functionIds; //* Only used to find functions by their name
+        Registry<Exposed> functions;                       //* Calls refer to functions by their id
+
+        std::string formatBuffer; //* Only used by `runCode` from the main thread
+
+        //* Counts the pages that were shown, calls of a previous page are dropped instead of resolved. Only changed
+        //* while holding the batch lock, so that the batch never holds resolutions of a previous page
+        std::atomic<std::uint32_t> epoch = 0;
+        //* Set once the window is being destroyed, calls that still finish are no longer resolved
+        std::atomic<bool> closing = false;
+
+        std::mutex batchMutex;
+        std::string batch;
+        std::size_t batchSize = 0;
+        bool flushScheduled = false;
+        std::size_t maxBatchSize = 256;
+        std::chrono::milliseconds maxBatchLatency{0};
+        BatchStats batchStats{};
+
+        std::mutex resultsMutex;
+        std::uint32_t lastResult = 0;
+        std::size_t largeResultThreshold = 0;
+        std::chrono::milliseconds resultTimeout{0};
+        std::map<std::uint32_t, Parked> results;
 
         std::mutex nativeCallRequestsMutex;
         std::map<std::uint32_t, JavaScriptFunction> nativeCallRequests;
+        std::chrono::milliseconds callTimeout{0};
+        //* Deadlines of calls that were responded to are only dropped once they passed
+        std::set<std::pair<std::chrono::steady_clock::time_point, std::uint32_t>> callDeadlines;
+        std::optional<std::chrono::steady_clock::time_point> nextSweep;
+        CallStats callStats{};
+
+        std::mutex runningMutex;
+        std::map<CallId, Running> running; //* Calls of `AsyncFunction`s that were not resolved yet
+
+        std::mutex flightsMutex;
+        std::map<CallId, Flight> flights;        //* Keyed by the call that runs
+        std::map<std::string, CallId> flightKeys; //* The function and parameters of a flight, to the call that runs
+
+        std::mutex codecMutex;
+        std::shared_ptr<Codec> codec = std::make_shared<JsonCodec>();
+
+        std::atomic<std::chrono::milliseconds> syncBudget{};
+
+        std::mutex executorMutex;
+        std::size_t poolSize = 0;
+        std::shared_ptr<Executor> executor;
+        std::shared_ptr<ThreadPool> pool;
+
+        std::mutex parserMutex;
+        std::shared_ptr<SerialExecutor> parser;
 
       protected:
         virtual bool onClose();
@@ -56,9 +239,91 @@ namespace Webview
         Resource getResource(const std::string &);
 #endif
 
-        virtual std::string formatCode(const std::string &);
-        virtual void handleRawCallRequest(const std::string &);
-        JavaScriptFunction &callFunctionInternal(JavaScriptFunction &&);
+        /// \returns The escaped code, which is either the given code itself or the given buffer
+        /// \remarks The buffer is only written to if the code needs escaping, so it can be reused across calls
+        virtual const std::string &formatCode(const std::string &, std::string &);
+        /// \returns The exposed function with the given name, or `nullptr` if there is none
+        const Exposed *getExposed(const std::string &);
+        /// \effects Handles the given message from javascript, on the parsing thread if background parsing is enabled
+        /// \remarks The message belongs to the page that is shown when it is received
+        void receiveMessage(std::string);
+        /// \returns Whether messages are handed to the parsing thread
+        bool isParsingInBackground();
+        /// \effects Handles the given message from javascript, which was sent by the page with the given epoch
+        virtual void handleRawCallRequest(const std::string &, std::uint32_t);
+        /// \effects Handles a message from javascript, which the given reader hands to the parser it is called with
+        /// \remarks The message was sent by the page with the given epoch
+        void handleMessage(const MessageReader &, std::uint32_t);
+        void handleCallRequest(FunctionCallRequest &&);
+        /// \effects Calls the given function, which is not async, and resolves the call with its result
+        void callSync(const Exposed &, FunctionCallRequest &);
+        void handleCallResponse(NativeCallResponse &&);
+        /// \effects Calls the given javascript function, the given callback is called with its result once javascript
+        /// responded
+        void callFunctionInternal(JavaScriptFunction &&, std::function<void(const nlohmann::json &)>,
+                                  std::function<void(std::exception_ptr)> = {});
+        /// \effects Runs the given call of a javascript function, whose result is handed to `handleCallResponse`
+        /// with the given sequence once it is known
+        /// \remarks Promises returned by the function are awaited
+        virtual void runCall(std::uint32_t, const std::string &);
+        /// \effects Fails the pending javascript calls whose deadline passed
+        /// \remarks Is scheduled for the earliest deadline, the given time is the one it was scheduled for
+        void sweep(std::chrono::steady_clock::time_point);
+        /// \effects Fails all pending javascript calls and cancels all running `AsyncFunction`s, as the page they
+        /// were made on is gone. Starts a new epoch, calls of the previous one are no longer resolved
+        void abandonCalls();
+        /// \returns The cancellation token of the given call
+        /// \remarks Calls that can't be cancelled get a token that never is
+        std::shared_ptr<CancellationToken> getCancellation(CallId);
+        /// \effects Cancels the given call if it is still running
+        void cancelCall(CallId);
+
+        std::shared_ptr<Executor> getExecutor();
+        std::shared_ptr<Codec> getCodec();
+
+        /// \effects Queues the resolution of the given javascript call
+        /// \remarks All resolutions that are queued until the next flush are run as a single script. Calls of a
+        /// previous page are dropped
+        void resolve(CallId, const nlohmann::json &);
+        /// \effects Queues the resolution of the given javascript call, using the given part of the resolving script as
+        /// it was produced by `appendResult`
+        void resolveEncoded(CallId, const std::string &);
+        /// \returns The given result in the form it is placed in the resolving script
+        EncodedResult encodeResult(const nlohmann::json &);
+        /// \effects Appends the part of the resolving script that resolves a call with the given result
+        static void appendResult(std::string &, const EncodedResult &);
+        /// \returns Whether the given call was made on the page that is shown, called while holding the batch lock
+        /// \remarks No call is current once the window shuts down
+        bool isCurrent(CallId) const;
+        /// \effects Appends the start of the resolution of the given call to the batch
+        void beginResolution(CallId);
+        /// \effects Queues the rejection of the given javascript call, which then fails with the given message
+        /// \remarks Does not free the concurrency slot of the call, calls that were started have to `finish` first.
+        /// Calls of a previous page are dropped
+        void reject(CallId, const std::string &);
+        /// \effects Forgets the given running call and starts the next waiting call in its slot
+        void finish(CallId);
+        /// \effects Ends the flight that was started by the given call
+        /// \returns The calls that joined it, which are to be resolved the same way
+        std::vector<CallId> land(CallId);
+        /// \effects Adds the given amount of resolutions to the batch and makes sure the batch is flushed
+        void scheduleFlush(std::unique_lock<std::mutex> &, std::size_t = 1);
+        void flush();
+
+        /// \returns The handle of the parked result, or an empty string if the encoded result is small enough to be
+        /// inlined
+        std::string park(const nlohmann::json &, std::string &);
+        /// \returns The parked result with the given id, which is removed from the table
+        std::optional<std::string> takeResult(std::uint32_t);
+
+        /// \effects Runs the given function on the main thread once the given delay has passed
+        virtual void dispatch(std::function<void()>, std::chrono::milliseconds) = 0;
+
+        /// \effects Stops handling calls: waits for the messages that are being parsed and the `AsyncFunction`s that
+        /// run on the default worker pool, and drops their resolutions
+        /// \remarks Must be called by the destructor of a window before the platform is torn down, as these calls still
+        /// dispatch to the window and run code in it
+        void shutdown();
 
       public:
         BaseWindow(const BaseWindow &) = delete;
@@ -99,26 +364,142 @@ namespace Webview
         virtual void enableDevTools(bool) = 0;
 
         /// \effects Exposes the given function
-        /// \remarks If the given Function is an `AsyncFunction` it will be run in a new thread
-        void expose(const Function &);
+        /// \remarks If the given Function is an `AsyncFunction` it will be run on the executor of the options, or the
+        /// window's executor if there is none. Calls over the concurrency limit of the options are queued or rejected
+        /// according to its policy, rejected calls fail in javascript
+        void expose(const Function &, ExposeOptions = {});
+        /// \effects Sets the executor that runs `AsyncFunction`s
+        /// \remarks Passing `nullptr` restores the default worker pool. Unlike the default pool, the window does not
+        /// wait for the calls that run on the given executor when it is destroyed
+        void setExecutor(std::shared_ptr<Executor>);
+        /// \effects Sets the amount of worker threads of the default worker pool
+        /// \remarks Defaults to the hardware concurrency, only has an effect before the first `AsyncFunction` is called
+        void setWorkerCount(std::size_t);
+        /// \returns The queue depth and wait times of the default worker pool
+        ThreadPool::Stats getWorkerStats();
+        /// \effects Sets how many results may be resolved by one script and how long they may be held back
+        /// \remarks A latency of `0` flushes on the next main loop iteration, which is the default
+        void setBatchLimits(std::size_t maxSize, std::chrono::milliseconds maxLatency);
+        /// \returns How many scripts were run to resolve calls and how many calls they resolved
+        BatchStats getBatchStats();
+        /// \effects Results whose serialized size reaches the given size are fetched by javascript through a custom
+        /// scheme instead of being inlined into the resolving script
+        /// \remarks A size of `0` disables this, which is the default. Results that were not fetched within the given
+        /// timeout are dropped, as are the ones of a page that navigated away. A timeout of `0` keeps them until then
+        void setLargeResultThreshold(std::size_t, std::chrono::milliseconds timeout = std::chrono::seconds(30));
+        /// \effects Sets the encoding of the messages javascript sends and of the results it receives
+        /// \remarks Passing `nullptr` restores json, which is the default. Should be called before the first
+        /// navigation, as it only takes effect on documents that are loaded afterwards
+        void setCodec(std::shared_ptr<Codec>);
+        /// \effects Makes messages from javascript be parsed and dispatched on a thread of their own, so that neither
+        /// large messages nor `Function`s hold up the main thread
+        /// \remarks `Function`s and the callbacks of `callFunction` are then called from that thread instead of the
+        /// main thread. Should be called before the first navigation and not from a `Function`
+        void enableBackgroundParsing(bool);
+        /// \effects Sets how long javascript may take to respond to a call before it fails with a `CallError`
+        /// \remarks Applies to calls that do not set their own timeout. A timeout of `0` disables this, which is the
+        /// default
+        void setCallTimeout(std::chrono::milliseconds);
+        /// \returns How many javascript calls are pending and how many failed
+        CallStats getCallStats();
+        /// \effects Sets how long a `Function` may take on the main thread, functions that take longer are run on the
+        /// executor from then on
+        /// \remarks A budget of `0` disables this, which is the default
+        void setSyncBudget(std::chrono::milliseconds);
+        /// \returns The functions that took longer than the budget and how long they took
+        std::vector<Promotion> getPromotions();
+        /// \returns How often the results of the exposed function with the given name were taken from its cache
+        /// \remarks Only functions that were exposed with a cache size are counted
+        ResultCache::Stats getCacheStats(const std::string &);
+        /// \returns How many calls of the exposed function with the given name run, wait and were rejected
+        /// \remarks Only calls of functions that were exposed with a concurrency limit are counted
+        ConcurrencyStats getConcurrencyStats(const std::string &);
         /// \effects Calls the given javascript function
         /// \returns The result of the javascript function call as `T`
         /// \preconditions `T` must be serializable by nlohmann::json
         /// \remarks You should never call `.get()` on the returned future in a **non async** context as it will
-        /// freeze the webview
+        /// freeze the webview. The future fails with a `CallError` if the call did not complete
         template <typename T = void> std::future<T> callFunction(JavaScriptFunction &&function)
         {
-            auto &future = callFunctionInternal(std::forward<JavaScriptFunction>(function));
-            auto result = future.getResult();
-
-            return std::async(std::launch::async, [result] {
-                if constexpr (!std::is_same_v<T, void>)
-                {
-                    return result.get().get<T>();
-                }
-            });
+            auto promise = std::make_shared<std::promise<T>>();
+            auto future = promise->get_future();
+
+            callFunctionInternal(
+                std::forward<JavaScriptFunction>(function),
+                [promise](const nlohmann::json &result) {
+                    try
+                    {
+                        if constexpr (std::is_same_v<T, void>)
+                        {
+                            promise->set_value();
+                        }
+                        else
+                        {
+                            promise->set_value(Helpers::fromJson<T>(result));
+                        }
+                    }
+                    catch (...)
+                    {
+                        promise->set_exception(std::current_exception());
+                    }
+                },
+                [promise](std::exception_ptr error) { promise->set_exception(std::move(error)); });
+
+            return future;
+        }
+        /// \effects Calls the given javascript function and calls the given callback with its result as `T`, or
+        /// without arguments if `T` is `void`
+        /// \preconditions `T` must be serializable by nlohmann::json
+        /// \remarks The callback is called from the main thread as soon as javascript responded, so no thread waits
+        /// for the result. It should not block, hand longer work to an executor instead. If the call did not complete
+        /// or its result could not be converted, the error callback is called instead, or the error is dropped if there
+        /// is none
+        template <typename T = void, typename Callback>
+        void callFunction(JavaScriptFunction &&function, Callback callback,
+                          std::function<void(std::exception_ptr)> onError = {})
+        {
+            callFunctionInternal(
+                std::forward<JavaScriptFunction>(function),
+                [callback = std::move(callback), onError](const nlohmann::json &result) {
+                    if constexpr (std::is_same_v<T, void>)
+                    {
+                        callback();
+                    }
+                    else
+                    {
+                        std::optional<T> converted;
+                        try
+                        {
+                            converted.emplace(Helpers::fromJson<T>(result));
+                        }
+                        catch (...)
+                        {
+                            //* Without an error callback the error is dropped, like the errors of the call itself
+                            if (onError)
+                            {
+                                onError(std::current_exception());
+                            }
+                            return;
+                        }
+
+                        callback(std::move(*converted));
+                    }
+                },
+                onError);
         }
 
+#if defined(WEBVIEWPP_COROUTINES)
+        /// \returns An awaitable that calls the given javascript function once it is awaited and evaluates to its
+        /// result as `T`
+        /// \preconditions `T` must be serializable by nlohmann::json
+        /// \remarks The awaiting coroutine is suspended until javascript responded and is then resumed on the window's
+        /// executor, so no thread waits for the result. Throws a `CallError` if the call did not complete
+        template <typename T = void> CallAwaitable<T> call(JavaScriptFunction &&function)
+        {
+            return CallAwaitable<T>(*this, std::forward<JavaScriptFunction>(function));
+        }
+#endif
+
         /// \effects Runs the given javascript code
         virtual void runCode(const std::string &) = 0;
         /// \effects Makes the given javascript code run on document load
@@ -132,4 +513,51 @@ namespace Webview
         /// \effects Sets the resize-callback to the given callback
         virtual void setResizeCallback(std::function<void(std::size_t, std::size_t)>);
     };
-} // namespace Webview
\ No newline at end of file
+
+#if defined(WEBVIEWPP_COROUTINES)
+    template <typename T> class CallAwaitable
+    {
+        BaseWindow &parent;
+        std::shared_ptr<JavaScriptFunction> function;
+
+        std::optional<nlohmann::json> result;
+        std::exception_ptr error;
+
+      public:
+        CallAwaitable(BaseWindow &parent, JavaScriptFunction &&function)
+            : parent(parent), function(std::make_shared<JavaScriptFunction>(function))
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            auto executor = parent.getExecutor();
+            parent.callFunctionInternal(
+                std::move(*function),
+                [this, coroutine, executor](const nlohmann::json &rtn) {
+                    result.emplace(rtn);
+                    executor->execute([coroutine] { coroutine.resume(); });
+                },
+                [this, coroutine, executor](std::exception_ptr rtn) {
+                    error = std::move(rtn);
+                    executor->execute([coroutine] { coroutine.resume(); });
+                });
+        }
+        T await_resume()
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+            if constexpr (!std::is_same_v<T, void>)
+            {
+                return Helpers::fromJson<T>(*result);
+            }
+        }
+    };
+#endif
+} // namespace Webview
@@ -0,0 +1,52 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace Webview
+{
+    //* Remembers the encoded results of a pure function by its parameters, evicting the least recently used ones
+    class ResultCache
+    {
+      public:
+        struct Stats
+        {
+            std::size_t size;
+            std::size_t hits;
+            std::size_t misses;
+            std::size_t evictions; //* Results that were dropped because the cache was full or they expired
+        };
+
+      private:
+        struct Entry
+        {
+            std::string key;
+            std::string value;
+            std::chrono::steady_clock::time_point expiry;
+        };
+
+        std::size_t capacity;
+        std::chrono::milliseconds ttl;
+
+        std::mutex mutex;
+        std::list<Entry> entries; //* Most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        Stats stats{};
+
+      public:
+        /// \remarks A time to live of `0` keeps results until they are evicted
+        ResultCache(std::size_t capacity, std::chrono::milliseconds ttl);
+
+        /// \returns The cached result for the given key, if there is one that did not expire
+        std::optional<std::string> get(const std::string &);
+        void put(std::string key, std::string value);
+        /// \effects Drops all cached results
+        void clear();
+
+        Stats getStats();
+    };
+} // namespace Webview
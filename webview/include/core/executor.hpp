@@ -0,0 +1,15 @@
+#pragma once
+#include <functional>
+
+namespace Webview
+{
+    class Executor
+    {
+      public:
+        virtual ~Executor() = default;
+
+        /// \effects Runs the given task
+        /// \remarks Is called from arbitrary threads and should not block until the task is done
+        virtual void execute(std::function<void()>) = 0;
+    };
+} // namespace Webview
@@ -0,0 +1,45 @@
+#pragma once
+#if defined(__linux__)
+#include <jsc/jsc.h>
+#include <json.hpp>
+#include <memory>
+#include <string>
+
+namespace Webview
+{
+    struct ValueDeleter
+    {
+        void operator()(JSCValue *value) const
+        {
+            g_object_unref(value);
+        }
+    };
+    using Value = std::unique_ptr<JSCValue, ValueDeleter>;
+
+    //* Walks a javascript value into the given parser the way `JSON.stringify` would write it. Javascript only posts
+    //* plain objects, arrays and primitives this way, see `_rpc_plain`, so toJSON and functions never show up here
+    class ValueReader
+    {
+        static constexpr std::size_t maxDepth = 512;
+        static constexpr double maxSafeInteger = 9007199254740992.0;
+
+        nlohmann::json_sax<nlohmann::json> &sax;
+        std::size_t depth = 0;
+        std::string buffer;
+
+        bool isSkipped(JSCValue *);
+
+        bool readNumber(double);
+        bool readString(JSCValue *);
+        bool readArray(JSCValue *);
+        bool readObject(JSCValue *);
+
+      public:
+        explicit ValueReader(nlohmann::json_sax<nlohmann::json> &);
+
+        /// \effects Feeds the given value to the parser
+        /// \returns Whether or not the parser accepted all of it
+        bool read(JSCValue *);
+    };
+} // namespace Webview
+#endif
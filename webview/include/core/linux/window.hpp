@@ -1,7 +1,11 @@
 #pragma once
 #if defined(__linux__)
+#include <atomic>
 #include <core/basewindow.hpp>
+#include <core/taskqueue.hpp>
 #include <gtk/gtk.h>
+#include <mutex>
+#include <set>
 #include <webkit2/webkit2.h>
 
 namespace Webview
@@ -11,6 +15,17 @@ namespace Webview
         GtkWidget *window;
         GtkWidget *webview;
 
+        //* Tasks for the main thread are drained by a single source, which is woken through an eventfd
+        int taskEvent;
+        GSource *taskSource;
+        TaskQueue tasks;
+
+        std::atomic<bool> directCalls = false; //* Only used with WebKitGTK 2.40 or later
+
+        //* Delayed tasks refer to the window, so the timers that are still pending are removed along with it
+        std::mutex timersMutex;
+        std::set<guint> timers;
+
         static void destroy(GtkWidget *, gpointer);
         static gboolean closed(GtkWidget *, GdkEvent *, gpointer);
         static gboolean resize(WebKitWebView *, GdkEvent *, gpointer);
@@ -18,18 +33,34 @@ namespace Webview
 #if defined(WEBVIEW_EMBEDDED)
         static void onUriRequested(WebKitURISchemeRequest *, gpointer);
 #endif
+        static void onResultRequested(WebKitURISchemeRequest *, gpointer);
 
         static void loadChanged(WebKitWebView *, WebKitLoadEvent, gpointer);
         static void messageReceived(WebKitUserContentManager *, WebKitJavascriptResult *, gpointer);
         static gboolean contextMenu(WebKitWebView *, GtkWidget *, WebKitHitTestResultContext *, gboolean, gpointer);
+        static gboolean runTasks(GSource *, GSourceFunc, gpointer);
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+        //* Cancelled once the window is gone, so that the results of calls that are still running are dropped
+        GCancellable *calls;
+        static void callFinished(GObject *, GAsyncResult *, gpointer);
+#endif
 
       private:
+        void wake();
         void runOnIdle(std::function<void()>);
 
+      protected:
+        void dispatch(std::function<void()>, std::chrono::milliseconds) override;
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+        void runCall(std::uint32_t, const std::string &) override;
+#endif
+
       public:
         Window(std::size_t width, std::size_t height);
         Window(const std::string &identifier, std::size_t width,
                std::size_t height); //* Identifier is not required on linux.
+        ~Window();
 
         void hide() override;
         void show() override;
@@ -45,6 +76,16 @@ namespace Webview
         void enableDevTools(bool state) override;
         void runCode(const std::string &code) override;
         void injectCode(const std::string &code) override;
+
+        /// \effects Makes javascript post its messages as they are instead of as json, which are then read from the
+        /// javascript values directly
+        /// \remarks Only used by the json codec. Messages that hold anything but plain objects, arrays and primitives
+        /// are still sent as json, as posting them would drop or fail on it
+        void enableStructuredMessages(bool);
+        /// \effects Makes `callFunction` return the result straight from the evaluation of the call, instead of
+        /// having javascript post it back as a message
+        /// \remarks Requires WebKitGTK 2.40, does nothing on older versions or while parsing in the background
+        void enableDirectCalls(bool);
     };
 } // namespace Webview
 #endif
\ No newline at end of file
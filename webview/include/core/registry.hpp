@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Webview
+{
+    //* Holds values under dense ids, values can be added but are never removed.
+    //* Lookups don't lock, they read from the current table of slots. A full table is replaced by a copy of twice its
+    //* size, the replaced tables are kept until the registry is destroyed as lookups may still be reading them.
+    template <typename T> class Registry
+    {
+        struct Table
+        {
+            std::size_t capacity;
+            std::unique_ptr<std::atomic<const T *>[]> slots;
+
+            explicit Table(std::size_t capacity)
+                : capacity(capacity), slots(std::make_unique<std::atomic<const T *>[]>(capacity))
+            {
+                for (std::size_t i = 0; capacity > i; i++)
+                {
+                    slots[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        std::mutex mutex; //* Only taken by writers
+        std::deque<T> values;
+        std::vector<std::unique_ptr<Table>> tables;
+        std::atomic<const Table *> table{nullptr};
+
+      public:
+        /// \returns The id of the added value
+        std::uint32_t add(T value)
+        {
+            std::lock_guard lock(mutex);
+
+            const auto id = static_cast<std::uint32_t>(values.size());
+            const auto &added = values.emplace_back(std::move(value));
+
+            const auto *current = table.load(std::memory_order_relaxed);
+            if (!current || id >= current->capacity)
+            {
+                auto grown = std::make_unique<Table>(current ? current->capacity * 2 : 64);
+                for (std::uint32_t i = 0; id > i; i++)
+                {
+                    grown->slots[i].store(&values[i], std::memory_order_relaxed);
+                }
+
+                current = tables.emplace_back(std::move(grown)).get();
+                table.store(current, std::memory_order_release);
+            }
+
+            current->slots[id].store(&added, std::memory_order_release);
+            return id;
+        }
+
+        /// \returns The value with the given id, or `nullptr` if there is none
+        const T *find(std::uint32_t id) const
+        {
+            const auto *current = table.load(std::memory_order_acquire);
+            if (!current || id >= current->capacity)
+            {
+                return nullptr;
+            }
+
+            return current->slots[id].load(std::memory_order_acquire);
+        }
+    };
+} // namespace Webview
@@ -0,0 +1,38 @@
+#pragma once
+#include "executor.hpp"
+#include "taskqueue.hpp"
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace Webview
+{
+    //* Runs tasks one after another on a thread of its own, in the order they were queued
+    class SerialExecutor : public Executor
+    {
+        TaskQueue tasks;
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool woken = false;
+        bool stopped = false;
+
+        std::thread thread; //* Declared last so that it only starts once everything else is set up
+
+        void run();
+
+      public:
+        SerialExecutor(const SerialExecutor &) = delete;
+        SerialExecutor &operator=(const SerialExecutor &) = delete;
+
+        SerialExecutor();
+        /// \remarks Runs the tasks that are still queued before it returns
+        ~SerialExecutor() override;
+
+        void execute(std::function<void()>) override;
+        /// \effects Runs the tasks that are still queued and waits for the thread to exit
+        /// \remarks Tasks that are queued afterwards are never run. Must not be called from a task
+        void stop();
+    };
+} // namespace Webview
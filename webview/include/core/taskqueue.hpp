@@ -0,0 +1,31 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Webview
+{
+    //* A queue for many producers and a single consumer. The consumer swaps the queued tasks out under the lock and
+    //* runs them without it, the two lists are swapped back and forth so that neither has to grow again.
+    class TaskQueue
+    {
+        std::mutex mutex;
+        std::vector<std::function<void()>> tasks;
+        bool signaled = false;
+
+        std::vector<std::function<void()>> draining; //* Only used by the consumer
+
+      public:
+        TaskQueue() = default;
+        TaskQueue(const TaskQueue &) = delete;
+        TaskQueue &operator=(const TaskQueue &) = delete;
+
+        /// \effects Queues the given task
+        /// \returns Whether or not the consumer has to be woken up, which is only the case for the first task that is
+        /// queued after the consumer started to drain
+        bool push(std::function<void()>);
+        /// \effects Runs the tasks that were queued before the call
+        /// \remarks Must only be called by the consumer. Tasks that are queued meanwhile wake the consumer again
+        void drain();
+    };
+} // namespace Webview
@@ -0,0 +1,83 @@
+#pragma once
+#include "executor.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Webview
+{
+    class ThreadPool : public Executor
+    {
+      public:
+        struct Stats
+        {
+            std::size_t threads;
+            std::size_t queued;   //* Tasks that are currently waiting for a worker
+            std::size_t executed; //* Tasks that have been started so far
+            std::size_t stolen;   //* Tasks that were taken from the queue of another worker
+
+            std::chrono::nanoseconds totalWait; //* Time tasks spent in a queue, summed up
+            std::chrono::nanoseconds maxWait;
+        };
+
+      private:
+        struct Task
+        {
+            std::function<void()> func;
+            std::chrono::steady_clock::time_point queuedAt;
+        };
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable sleepCondition;
+        bool stopped = false;
+
+        std::atomic<std::size_t> next = 0;
+        std::atomic<std::size_t> queued = 0;
+        std::atomic<std::size_t> executed = 0;
+        std::atomic<std::size_t> stolen = 0;
+        std::atomic<std::int64_t> totalWait = 0;
+        std::atomic<std::int64_t> maxWait = 0;
+
+        bool pop(std::size_t, Task &);
+        void work(std::size_t);
+        void run(Task &);
+
+      public:
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        /// \remarks A size of `0` will use the hardware concurrency
+        explicit ThreadPool(std::size_t size = 0);
+        ~ThreadPool() override;
+
+        /// \effects Queues the given task
+        /// \remarks Tasks posted from a worker are queued on that worker, idle workers steal from the others. Tasks
+        /// posted once the pool stopped are dropped
+        void execute(std::function<void()>) override;
+        /// \effects Runs the tasks that are still queued, including the ones they post, and waits for the workers to
+        /// exit
+        /// \remarks Must not be called from a worker
+        void stop();
+
+        /// \returns The amount of worker threads
+        std::size_t size() const;
+        /// \returns The current queue depth, the amount of executed tasks and how long they had to wait
+        Stats getStats() const;
+    };
+} // namespace Webview
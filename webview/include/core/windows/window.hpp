@@ -17,6 +17,9 @@ namespace Webview
         HWND hwnd = nullptr;
 
         std::vector<std::function<void()>> runOnControllerCreated;
+
+        UINT_PTR lastTimer = 0;
+        std::map<UINT_PTR, std::function<void()>> timers;
         wil::com_ptr<ICoreWebView2Controller> webViewController;
         wil::com_ptr<ICoreWebView2> webViewWindow;
 
@@ -26,6 +29,7 @@ namespace Webview
         HRESULT onWebResourceRequested(ICoreWebView2 *, ICoreWebView2WebResourceRequestedEventArgs *);
 #endif
 
+        HRESULT onResultRequested(ICoreWebView2 *, ICoreWebView2WebResourceRequestedEventArgs *);
         HRESULT onNavigationCompleted(ICoreWebView2 *, ICoreWebView2NavigationCompletedEventArgs *);
         HRESULT onMessageReceived(ICoreWebView2 *, ICoreWebView2WebMessageReceivedEventArgs *);
         HRESULT onControllerCreated(ICoreWebView2Controller *);
@@ -37,8 +41,12 @@ namespace Webview
         void dispatchMessage(std::function<void()>);
         void onResize(std::size_t width, std::size_t height) override;
 
+      protected:
+        void dispatch(std::function<void()>, std::chrono::milliseconds) override;
+
       public:
         Window(std::string identifier, std::size_t width, std::size_t height);
+        ~Window();
         void disableAcceleratorKeys(bool);
 
         void hide() override;
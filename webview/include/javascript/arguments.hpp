@@ -0,0 +1,320 @@
+#pragma once
+#include <cstdint>
+#include <exception>
+#include <javascript/call.hpp>
+#include <json.hpp>
+#include <json/builder.hpp>
+#include <misc/helpers.hpp>
+#include <misc/traits.hpp>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Webview
+{
+    class BaseWindow;
+
+    //* Receives the sax events of the `params` array of a call and parses them straight into the arguments of the
+    //* called function, so that the arguments never have to exist as a json value
+    class Arguments : public nlohmann::json_sax<nlohmann::json>
+    {
+      public:
+        ~Arguments() override = default;
+
+        /// \effects Calls the function with the parsed arguments
+        /// \returns The result of the function, `AsyncFunction`s return `null` and resolve through their `Promise`
+        /// \remarks Rethrows the first error that occurred while parsing the arguments
+        virtual nlohmann::json invoke(BaseWindow &, CallId) = 0;
+    };
+
+    template <typename Tuple, typename Assign, typename Callback> class TypedArguments : public Arguments
+    {
+        Tuple arguments;
+        Assign assign;     //* Converts a json value into an argument, used for everything that is not a plain scalar
+        Callback callback; //* Calls the function with the argument tuple
+
+        std::size_t depth = 0;
+        std::size_t index = 0;
+        bool direct = false; //* Whether or not the current argument is a vector that is appended to directly
+        std::exception_ptr error;
+        std::optional<JsonBuilder> builder; //* Only set while a compound argument is parsed
+
+        template <typename Function> void visit(Function func)
+        {
+            try
+            {
+                Helpers::visitTuple(arguments, index, func);
+            }
+            catch (...)
+            {
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+
+        template <typename T> bool set(T &&value)
+        {
+            if (depth != 1)
+            {
+                return false;
+            }
+
+            visit([&](auto &val) {
+                using val_t = std::decay_t<decltype(val)>;
+                using value_t = std::decay_t<T>;
+
+                //* Scalars that fit the argument as they are don't need to go through nlohmann::json
+                if constexpr (std::is_same_v<value_t, std::string>)
+                {
+                    if constexpr (std::is_same_v<val_t, std::string>)
+                    {
+                        val = std::forward<T>(value);
+                        return;
+                    }
+                }
+                else if constexpr (std::is_same_v<val_t, bool>)
+                {
+                    if constexpr (std::is_same_v<value_t, bool>)
+                    {
+                        val = value;
+                        return;
+                    }
+                }
+                else if constexpr (std::is_arithmetic_v<val_t> && std::is_arithmetic_v<value_t>)
+                {
+                    val = static_cast<val_t>(value);
+                    return;
+                }
+
+                assign(val, nlohmann::json(std::forward<T>(value)));
+            });
+
+            index++;
+            return true;
+        }
+
+        /// \returns Whether or not the started value is the parameter array itself
+        bool begin(bool array)
+        {
+            if (depth++ == 0)
+            {
+                return true;
+            }
+            if (direct)
+            {
+                spill();
+            }
+            if (depth == 2 && index < std::tuple_size_v<Tuple>)
+            {
+                if (array && startDirect())
+                {
+                    direct = true;
+                }
+                else
+                {
+                    builder.emplace();
+                }
+            }
+
+            return false;
+        }
+
+        void end()
+        {
+            if (--depth == 1)
+            {
+                if (builder)
+                {
+                    visit([this](auto &val) { assign(val, builder->get()); });
+                    builder.reset();
+                }
+
+                direct = false;
+                index++;
+            }
+        }
+
+        //* Arrays of numbers are appended to numeric vector arguments directly. If such an array turns out to contain
+        //* anything else, it is handed to a builder instead.
+
+        bool startDirect()
+        {
+            bool rtn = false;
+            visit([&rtn](auto &val) {
+                if constexpr (Traits::is_numeric_vector<std::decay_t<decltype(val)>>::value)
+                {
+                    val.clear();
+                    rtn = true;
+                }
+            });
+
+            return rtn;
+        }
+
+        template <typename T> void append(T value)
+        {
+            visit([value](auto &val) {
+                using val_t = std::decay_t<decltype(val)>;
+                if constexpr (Traits::is_numeric_vector<val_t>::value)
+                {
+                    val.push_back(static_cast<typename val_t::value_type>(value));
+                }
+            });
+        }
+
+        void spill()
+        {
+            direct = false;
+            builder.emplace();
+            builder->start_array(static_cast<std::size_t>(-1));
+
+            visit([this](auto &val) {
+                using val_t = std::decay_t<decltype(val)>;
+                if constexpr (Traits::is_numeric_vector<val_t>::value)
+                {
+                    using value_t = typename val_t::value_type;
+                    for (const auto &element : val)
+                    {
+                        if constexpr (std::is_floating_point_v<value_t>)
+                        {
+                            builder->number_float(element, {});
+                        }
+                        else if constexpr (std::is_signed_v<value_t>)
+                        {
+                            builder->number_integer(element);
+                        }
+                        else
+                        {
+                            builder->number_unsigned(element);
+                        }
+                    }
+
+                    val.clear();
+                }
+            });
+        }
+
+        /// \returns Whether or not the value was appended to the current vector argument
+        template <typename T> bool nested(T value)
+        {
+            if (direct)
+            {
+                if constexpr (std::is_arithmetic_v<T>)
+                {
+                    append(value);
+                    return true;
+                }
+                else
+                {
+                    spill();
+                }
+            }
+
+            return false;
+        }
+
+      public:
+        TypedArguments(Assign assign, Callback callback) : assign(std::move(assign)), callback(std::move(callback)) {}
+
+        bool null() override
+        {
+            return depth > 1 ? nested(nullptr) || !builder || builder->null() : set(nullptr);
+        }
+        bool boolean(bool value) override
+        {
+            return depth > 1 ? nested(value) || !builder || builder->boolean(value) : set(value);
+        }
+        bool number_integer(number_integer_t value) override
+        {
+            return depth > 1 ? nested(value) || !builder || builder->number_integer(value) : set(value);
+        }
+        bool number_unsigned(number_unsigned_t value) override
+        {
+            return depth > 1 ? nested(value) || !builder || builder->number_unsigned(value) : set(value);
+        }
+        bool number_float(number_float_t value, const string_t &raw) override
+        {
+            return depth > 1 ? nested(value) || !builder || builder->number_float(value, raw) : set(value);
+        }
+        bool string(string_t &value) override
+        {
+            return depth > 1 ? nested(nullptr) || !builder || builder->string(value) : set(std::move(value));
+        }
+        bool binary(binary_t &value) override
+        {
+            return depth > 1 ? nested(nullptr) || !builder || builder->binary(value)
+                             : set(nlohmann::json::binary(std::move(value)));
+        }
+
+        bool start_object(std::size_t elements) override
+        {
+            //* The parameters themselves have to be an array
+            if (depth == 0)
+            {
+                return false;
+            }
+
+            begin(false);
+            return !builder || builder->start_object(elements);
+        }
+        bool key(string_t &value) override
+        {
+            return !builder || builder->key(value);
+        }
+        bool end_object() override
+        {
+            if (builder && !builder->end_object())
+            {
+                return false;
+            }
+
+            end();
+            return true;
+        }
+
+        bool start_array(std::size_t elements) override
+        {
+            if (begin(true) || direct)
+            {
+                return true;
+            }
+
+            return !builder || builder->start_array(elements);
+        }
+        bool end_array() override
+        {
+            if (depth == 1)
+            {
+                depth = 0;
+                return true;
+            }
+            if (builder && !builder->end_array())
+            {
+                return false;
+            }
+
+            end();
+            return true;
+        }
+
+        bool parse_error([[maybe_unused]] std::size_t position, [[maybe_unused]] const std::string &lastToken,
+                         [[maybe_unused]] const nlohmann::detail::exception &exception) override
+        {
+            return false;
+        }
+
+        nlohmann::json invoke(BaseWindow &parent, CallId id) override
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+
+            return callback(parent, id, arguments);
+        }
+    };
+} // namespace Webview
@@ -1,20 +1,64 @@
 #pragma once
 #include <cstdint>
 #include <json.hpp>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 
 namespace Webview
 {
+    //* Identifies a call from javascript across pages, as every page starts its own sequences
+    using CallId = std::uint64_t;
+
+    /// \returns The id of the call with the given sequence that was made on the page with the given epoch
+    inline CallId makeCallId(std::uint32_t epoch, std::uint32_t seq)
+    {
+        return static_cast<CallId>(epoch) << 32 | seq;
+    }
+
+    class Arguments;
     struct FunctionCallRequest
     {
         std::uint32_t seq;
-        std::string function;
+        std::uint32_t function; //* The id the function was exposed with
         nlohmann::json params;
+        std::shared_ptr<Arguments> arguments; //* Set if the parameters were parsed into the arguments directly
+        std::uint32_t epoch = 0;              //* The page the call was made on, set by the window
+
+        CallId id() const
+        {
+            return makeCallId(epoch, seq);
+        }
     };
 
     struct NativeCallResponse
     {
         std::uint32_t seq;
         nlohmann::json result;
+        std::optional<std::string> error; //* Set if the called javascript function threw
+    };
+
+    //* The error that the result of a javascript call fails with if the call did not complete
+    class CallError : public std::runtime_error
+    {
+      public:
+        enum class Reason
+        {
+            Exception, //* The javascript function threw
+            Timeout,   //* Javascript did not respond before the deadline of the call
+            Abandoned, //* The page navigated away before it responded
+        };
+
+      private:
+        Reason reason;
+
+      public:
+        CallError(Reason reason, const std::string &message) : std::runtime_error(message), reason(reason) {}
+
+        Reason getReason() const
+        {
+            return reason;
+        }
     };
 } // namespace Webview
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace Webview
+{
+    //* Cancelled once javascript no longer waits for the result of a call, which is the case if the call was aborted
+    //* or the page navigated away
+    class CancellationToken
+    {
+        std::atomic<bool> cancelled = false;
+
+        std::mutex callbacksMutex;
+        std::vector<std::function<void()>> callbacks;
+
+      public:
+        /// \returns Whether or not the call was cancelled
+        bool isCancelled() const;
+        /// \effects Calls the given callback once the call is cancelled, or right away if it already is
+        /// \remarks The callback is called from the thread that cancels the call, which usually is the main thread
+        void onCancel(std::function<void()>);
+
+        /// \effects Cancels the call and calls the registered callbacks
+        void cancel();
+    };
+} // namespace Webview
@@ -0,0 +1,177 @@
+#pragma once
+#if defined(WEBVIEWPP_COROUTINES)
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace Webview
+{
+    template <typename T> class Task;
+
+    namespace Traits
+    {
+        template <typename T> struct is_task : std::false_type
+        {
+        };
+        template <typename T> struct is_task<Task<T>> : std::true_type
+        {
+        };
+    } // namespace Traits
+
+    namespace Detail
+    {
+        template <typename T> struct TaskResult
+        {
+            std::optional<T> value;
+            std::exception_ptr error;
+
+            void return_value(T result)
+            {
+                value.emplace(std::move(result));
+            }
+
+            T get()
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+
+                return std::move(*value);
+            }
+        };
+        template <> struct TaskResult<void>
+        {
+            std::exception_ptr error;
+
+            void return_void() {}
+
+            void get()
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        };
+    } // namespace Detail
+
+    //* A coroutine that starts once it is awaited or started, which is how `AsyncFunction`s return their value
+    template <typename T = void> class Task
+    {
+      public:
+        struct promise_type : Detail::TaskResult<T>
+        {
+            std::coroutine_handle<> continuation;
+            std::function<void(promise_type &)> callback;
+
+            struct FinalAwaiter
+            {
+                bool await_ready() const noexcept
+                {
+                    return false;
+                }
+
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept
+                {
+                    auto &promise = coroutine.promise();
+                    if (promise.continuation)
+                    {
+                        return promise.continuation;
+                    }
+
+                    //* A started task owns itself, so it is destroyed once its callback has seen the result
+                    if (promise.callback)
+                    {
+                        auto callback = std::move(promise.callback);
+                        callback(promise);
+                        coroutine.destroy();
+                    }
+
+                    return std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+
+            Task get_return_object()
+            {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() const noexcept
+            {
+                return {};
+            }
+            FinalAwaiter final_suspend() const noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception()
+            {
+                this->error = std::current_exception();
+            }
+        };
+
+      private:
+        std::coroutine_handle<promise_type> coroutine;
+
+        explicit Task(std::coroutine_handle<promise_type> coroutine) : coroutine(coroutine) {}
+
+      public:
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+
+        Task(Task &&other) noexcept : coroutine(std::exchange(other.coroutine, {})) {}
+        Task &operator=(Task &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (coroutine)
+                {
+                    coroutine.destroy();
+                }
+
+                coroutine = std::exchange(other.coroutine, {});
+            }
+
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (coroutine)
+            {
+                coroutine.destroy();
+            }
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+        {
+            coroutine.promise().continuation = awaiting;
+            return coroutine;
+        }
+        T await_resume()
+        {
+            return coroutine.promise().get();
+        }
+
+        /// \effects Runs the task, the given callback is called with its promise once it is done
+        /// \remarks The task keeps itself alive until then
+        void start(std::function<void(promise_type &)> callback) &&
+        {
+            auto handle = std::exchange(coroutine, {});
+            handle.promise().callback = std::move(callback);
+            handle.resume();
+        }
+    };
+} // namespace Webview
+#endif
@@ -1,12 +1,18 @@
 #pragma once
+#include <chrono>
+#include <exception>
 #include <functional>
 #include <future>
+#include <javascript/arguments.hpp>
+#include <javascript/coroutine.hpp>
 #include <javascript/promise.hpp>
 #include <json.hpp>
+#include <json/binary.hpp>
+#include <memory>
 #include <misc/helpers.hpp>
 #include <misc/traits.hpp>
-#include <regex>
 #include <string>
+#include <tuple>
 
 namespace Webview
 {
@@ -15,9 +21,18 @@ namespace Webview
 
     class Function
     {
+      public:
+        enum class Kind
+        {
+            Sync,  //* Returns its result
+            Async, //* Is an `AsyncFunction`, which resolves its result through a `Promise` or a `Task`
+        };
+
       protected:
+        Kind kind = Kind::Sync;
         std::string name;
         std::function<nlohmann::json(const nlohmann::json &)> parserFunction;
+        std::function<std::shared_ptr<Arguments>()> argumentsFactory;
 
       public:
         Function() = default;
@@ -28,29 +43,22 @@ namespace Webview
             using rtn_t = typename func_traits::return_t;
             using arg_t = typename func_traits::arg_t;
 
-            // NOLINTNEXTLINE
-            parserFunction = [this, function](const nlohmann::json &j) -> nlohmann::json {
-                arg_t packedArgs;
-                Helpers::setTuple(packedArgs, [&j](auto index, auto &val) {
-                    if (j.size() > index)
+            auto assign = [](auto &val, const nlohmann::json &j) {
+                if (!j.is_null())
+                {
+                    if constexpr (Traits::is_optional<std::decay_t<decltype(val)>>::value ||
+                                  Traits::is_shared_ptr<std::decay_t<decltype(val)>>::value)
                     {
-                        if (!j.at(index).is_null())
-                        {
-                            if constexpr (Traits::is_optional<std::decay_t<decltype(val)>>::value ||
-                                          Traits::is_shared_ptr<std::decay_t<decltype(val)>>::value)
-                            {
-                                val =
-                                    j.at(index)
-                                        .template get<std::decay_t<typename std::decay_t<decltype(val)>::value_type>>();
-                            }
-                            else
-                            {
-                                j.at(index).get_to(val);
-                            }
-                        }
+                        val = Helpers::fromJson<std::decay_t<typename std::decay_t<decltype(val)>::value_type>>(j);
                     }
-                });
+                    else
+                    {
+                        val = Helpers::fromJson<std::decay_t<decltype(val)>>(j);
+                    }
+                }
+            };
 
+            auto call = [function](arg_t &packedArgs) -> nlohmann::json {
                 if constexpr (std::is_void_v<rtn_t>)
                 {
                     //* If the function return type is void we just need to call it and ignore the return type
@@ -72,58 +80,169 @@ namespace Webview
                         //* Just to make sure this wont break with optionals
                         if (rtn)
                         {
-                            return nlohmann::json(*rtn);
+                            return Helpers::toJson(*rtn);
                         }
                     }
                     else
                     {
-                        return nlohmann::json(rtn);
+                        return Helpers::toJson(rtn);
                     }
                 }
 
                 return nullptr;
             };
+
+            // NOLINTNEXTLINE
+            parserFunction = [assign, call](const nlohmann::json &j) -> nlohmann::json {
+                arg_t packedArgs;
+                Helpers::setTuple(packedArgs, [&j, &assign](auto index, auto &val) {
+                    if (j.size() > index)
+                    {
+                        assign(val, j.at(index));
+                    }
+                });
+
+                return call(packedArgs);
+            };
+
+            auto invoke = [call]([[maybe_unused]] BaseWindow &parent, [[maybe_unused]] CallId id,
+                                 arg_t &packedArgs) { return call(packedArgs); };
+            argumentsFactory = [assign, invoke] {
+                return std::make_shared<TypedArguments<arg_t, decltype(assign), decltype(invoke)>>(assign, invoke);
+            };
         }
 
         std::string getName() const;
-        std::function<nlohmann::json(const nlohmann::json &)> getFunc() const;
+        /// \remarks Tells apart functions without RTTI, a function of kind `Async` can be cast to an `AsyncFunction`
+        Kind getKind() const;
+        const std::function<nlohmann::json(const nlohmann::json &)> &getFunc() const;
+        /// \returns A parser that turns the parameters of a call into the arguments of this function
+        std::shared_ptr<Arguments> makeArguments() const;
     };
 
     class AsyncFunction : public Function
     {
       protected:
-        std::function<void(BaseWindow &, const nlohmann::json &, std::uint32_t)> parserFunction;
+        std::function<void(BaseWindow &, const nlohmann::json &, CallId)> parserFunction;
+
+        template <typename args_t, typename call_t> void setup(call_t call)
+        {
+            auto assign = [](auto &val, const nlohmann::json &j) {
+                val = Helpers::fromJson<std::decay_t<decltype(val)>>(j);
+            };
+
+            // NOLINTNEXTLINE
+            parserFunction = [assign, call](BaseWindow &parent, const nlohmann::json &j, CallId id) {
+                args_t packedArgs;
+                Helpers::setTuple(packedArgs, [&j, &assign](auto index, auto &val) {
+                    if (j.size() > index)
+                    {
+                        assign(val, j.at(index));
+                    }
+                });
+
+                call(parent, id, packedArgs);
+            };
+            argumentsFactory = [assign, call] {
+                return std::make_shared<TypedArguments<args_t, decltype(assign), decltype(call)>>(assign, call);
+            };
+        }
+
+#if defined(WEBVIEWPP_COROUTINES)
+        //* The coroutine refers to the captures of the function and to its arguments once it suspended, so they are
+        //* kept alive until it is done. `complete` turns the arguments from javascript into the ones of the coroutine
+        template <typename args_t, typename func_t, typename complete_t>
+        void setupTask(const func_t &function, complete_t complete)
+        {
+            auto coroutine = std::make_shared<func_t>(function);
+            setup<args_t>([coroutine, complete](BaseWindow &parent, CallId id, args_t &packedArgs) -> nlohmann::json {
+                Promise promise(parent, id);
+
+                using arguments_t = decltype(complete(promise, packedArgs));
+                auto arguments = std::make_shared<arguments_t>(complete(promise, packedArgs));
+                auto task = std::apply(*coroutine, *arguments);
+
+                std::move(task).start([coroutine, arguments, promise](auto &result) {
+                    //* Coroutines that throw fail the call, the same as functions that take a `Promise`
+                    try
+                    {
+                        if constexpr (std::is_void_v<decltype(result.get())>)
+                        {
+                            result.get();
+                            promise.discard();
+                        }
+                        else
+                        {
+                            promise.resolve(Helpers::toJson(result.get()));
+                        }
+                    }
+                    catch (const std::exception &e)
+                    {
+                        promise.reject(e.what());
+                    }
+                    catch (...)
+                    {
+                        promise.reject("Unknown error in coroutine");
+                    }
+                });
+
+                return nullptr;
+            });
+        }
+#endif
 
       public:
         template <typename func_t> AsyncFunction(std::string name, const func_t &function) : Function()
         {
+            this->kind = Kind::Async;
             this->name = std::move(name);
 
             using func_traits = Traits::func_traits<func_t>;
             using rtn_t = typename func_traits::return_t;
             using arg_t = typename func_traits::arg_t;
 
-            static_assert(std::is_same_v<rtn_t, void>);
-            static_assert(std::is_same_v<std::decay_t<decltype(std::get<0>(std::declval<arg_t>()))>, Promise>);
+#if defined(WEBVIEWPP_COROUTINES)
+            if constexpr (Traits::is_task<rtn_t>::value)
+            {
+                //* Coroutines take their arguments from javascript and resolve with the value they return. One whose
+                //* first parameter is a `std::shared_ptr<CancellationToken>` gets the token of the call there
+                using token_t = std::shared_ptr<CancellationToken>;
+                if constexpr (Traits::is_first<token_t, arg_t>::value)
+                {
+                    using args_t = Traits::ignore_first<arg_t>;
+                    setupTask<args_t>(function, [](const Promise &promise, args_t &packedArgs) {
+                        return std::tuple_cat(std::tuple<token_t>(promise.getToken()), std::move(packedArgs));
+                    });
+                }
+                else
+                {
+                    setupTask<arg_t>(function, []([[maybe_unused]] const Promise &promise,
+                                                  arg_t &packedArgs) { return std::move(packedArgs); });
+                }
+            }
+            else
+#endif
+            {
+                static_assert(std::is_same_v<rtn_t, void>);
+                static_assert(std::is_same_v<std::decay_t<decltype(std::get<0>(std::declval<arg_t>()))>, Promise>);
 
-            // NOLINTNEXTLINE
-            parserFunction = [this, function](BaseWindow &parent, const nlohmann::json &j, std::uint32_t seq) {
-                //* Return type is always void
-                Traits::ignore_first<arg_t> packedArgs;
-                Helpers::setTuple(packedArgs, [&j](auto index, auto &val) {
-                    if (j.size() > index)
-                    {
-                        j.at(index).get_to(val);
-                    }
-                });
+                using args_t = Traits::ignore_first<arg_t>;
 
-                auto unpack = [&parent, function, seq](auto &&...args) { function(Promise(parent, seq), args...); };
-                std::apply(unpack, packedArgs);
-            };
+                setup<args_t>(
+                    [function](BaseWindow &parent, CallId id, args_t &packedArgs) -> nlohmann::json {
+                        //* Return type is always void
+                        auto unpack = [&parent, function, id](auto &&...args) {
+                            function(Promise(parent, id), args...);
+                        };
+                        std::apply(unpack, packedArgs);
+
+                        return nullptr;
+                    });
+            }
         }
 
         ~AsyncFunction() override = default;
-        std::function<void(BaseWindow &, const nlohmann::json &, std::uint32_t)> getFunc() const;
+        const std::function<void(BaseWindow &, const nlohmann::json &, CallId)> &getFunc() const;
     };
 
     class JavaScriptFunction
@@ -137,11 +256,16 @@ namespace Webview
         std::mutex argumentsMutex;
         std::vector<nlohmann::json> arguments;
 
+        std::function<void(const nlohmann::json &)> callback;
+        std::function<void(std::exception_ptr)> errorCallback;
+
+        std::chrono::milliseconds timeout{0};
+
       public:
         template <typename... T> JavaScriptFunction(std::string name, const T &...params) : name(std::move(name))
         {
             std::lock_guard guard(argumentsMutex);
-            auto unpack = [this](auto &&arg) { arguments.emplace_back(nlohmann::json(arg)); };
+            auto unpack = [this](auto &&arg) { arguments.emplace_back(Helpers::toJson(arg)); };
             (unpack(params), ...);
         }
         JavaScriptFunction(JavaScriptFunction &);
@@ -150,6 +274,17 @@ namespace Webview
         std::vector<nlohmann::json> getArguments() const;
 
         void resolve(const nlohmann::json &);
+        /// \effects Fails the result with the given error
+        void reject(std::exception_ptr);
         std::shared_future<nlohmann::json> getResult();
+        /// \effects Makes `resolve` call the given callback instead of fulfilling the result, and `reject` the given
+        /// error callback
+        /// \remarks Errors are dropped if there is no error callback
+        void setCallback(std::function<void(const nlohmann::json &)>, std::function<void(std::exception_ptr)> = {});
+
+        /// \effects Makes the call fail with a `CallError` if javascript did not respond within the given time
+        /// \remarks A timeout of `0` uses the timeout of the window
+        void setTimeout(std::chrono::milliseconds);
+        std::chrono::milliseconds getTimeout() const;
     };
 } // namespace Webview
\ No newline at end of file
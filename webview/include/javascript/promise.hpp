@@ -1,21 +1,41 @@
 #pragma once
 #include <cstdint>
+#include <javascript/call.hpp>
+#include <javascript/cancellation.hpp>
 #include <json.hpp>
+#include <json/binary.hpp>
+#include <memory>
 #include <misc/traits.hpp>
+#include <string>
 
 namespace Webview
 {
     class BaseWindow;
     class Promise
     {
-        std::uint32_t id;
+        CallId id;
         BaseWindow &parent;
+        std::shared_ptr<CancellationToken> token;
 
       public:
-        Promise(BaseWindow &parent, std::uint32_t id);
+        Promise(BaseWindow &parent, CallId id);
+
+        /// \returns Whether or not javascript stopped waiting for the result
+        /// \remarks Long running functions should check this and stop early if it returns `true`
+        bool isCancelled() const;
+        /// \returns The token that is cancelled once javascript aborts the call or the page navigates away
+        std::shared_ptr<CancellationToken> getToken() const;
 
         void discard() const;
         void resolve(const nlohmann::json &) const;
+        /// \effects Fails the call in javascript with the given message
+        void reject(const std::string &) const;
+
+        template <typename T> void resolve(const TypedArray<T> &result) const
+        {
+            //* Sent as binary, see `TypedArray`
+            resolve(Helpers::toJson(result));
+        }
 
         template <typename T> void resolve(const std::optional<T> &result)
         {
@@ -0,0 +1,73 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace Webview
+{
+    class Template
+    {
+        static constexpr std::size_t maxParts = 16;
+        static constexpr std::size_t noPlaceholder = static_cast<std::size_t>(-1);
+
+        struct Part
+        {
+            std::string_view text;
+            std::size_t placeholder;
+        };
+
+        std::size_t count = 0;
+        std::array<Part, maxParts> parts{};
+
+        void append(std::string &, const std::string_view *, std::size_t) const;
+
+      public:
+        //* Splits the source at every `{n}` (with n being a single digit), this is done once at compile time for all
+        //* templates that are initialized from a string literal.
+        constexpr Template(std::string_view source)
+        {
+            std::size_t start = 0;
+            for (std::size_t i = 0; i + 2 < source.size(); i++)
+            {
+                if (source[i] == '{' && source[i + 1] >= '0' && source[i + 1] <= '9' && source[i + 2] == '}')
+                {
+                    push(source.substr(start, i - start), static_cast<std::size_t>(source[i + 1] - '0'));
+                    start = i + 3;
+                    i += 2;
+                }
+            }
+
+            push(source.substr(start), noPlaceholder);
+        }
+        constexpr Template(const char *source) : Template(std::string_view(source)) {}
+
+        /// \effects Appends the template to `out`, replacing every `{n}` with the n-th value
+        /// \remarks The buffer is grown at most once
+        template <typename... T> void formatTo(std::string &out, const T &...values) const
+        {
+            const std::array<std::string_view, sizeof...(T)> args{std::string_view(values)...};
+            append(out, args.data(), args.size());
+        }
+        /// \returns The template with every `{n}` replaced by the n-th value
+        template <typename... T> std::string format(const T &...values) const
+        {
+            std::string rtn;
+            formatTo(rtn, values...);
+
+            return rtn;
+        }
+
+      private:
+        constexpr void push(std::string_view text, std::size_t placeholder)
+        {
+            if (count == maxParts)
+            {
+                throw std::length_error("Template has too many placeholders");
+            }
+
+            parts[count++] = Part{text, placeholder};
+        }
+    };
+} // namespace Webview
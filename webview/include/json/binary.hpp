@@ -0,0 +1,134 @@
+#pragma once
+#include <cstddef>
+#include <json.hpp>
+#include <misc/traits.hpp>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Webview
+{
+    //* A vector of numbers that reaches javascript as the matching TypedArray instead of as an array of numbers.
+    //* 64 bit integers are not supported, as their TypedArrays hold BigInts which don't mix with Numbers.
+    template <typename T> class TypedArray : public std::vector<T>
+    {
+        static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                          (std::is_floating_point_v<T> || sizeof(T) <= 4),
+                      "TypedArray only supports floating point numbers and integers of up to 32 bit");
+
+      public:
+        using std::vector<T>::vector;
+        TypedArray() = default;
+        TypedArray(std::vector<T> values) : std::vector<T>(std::move(values)) {}
+    };
+
+    namespace Binary
+    {
+        //* A `TypedArray` is sent as `{"_rpc_binary": "<base64>", "type": "<TypedArray>"}`, the javascript side turns
+        //* it into the corresponding TypedArray. TypedArrays and ArrayBuffers from javascript arrive in the same form
+        //* and can be received as a `TypedArray` or as a `std::vector` of the matching element type, vectors of bytes
+        //* also accept ArrayBuffers.
+
+        std::string encode(const void *, std::size_t);
+        /// \returns The amount of bytes the given base64 string decodes to
+        std::size_t decodedSize(const std::string &);
+        /// \effects Decodes the given base64 string into the given buffer, which has to hold `decodedSize` bytes
+        /// \returns Whether or not the string was valid base64
+        bool decode(const std::string &, void *);
+
+        /// \returns Whether or not the given json is an encoded buffer
+        bool isBinary(const nlohmann::json &);
+
+        template <typename T> constexpr const char *typeName()
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                return sizeof(T) == 4 ? "Float32Array" : "Float64Array";
+            }
+            else if constexpr (sizeof(T) == 1)
+            {
+                return std::is_signed_v<T> ? "Int8Array" : "Uint8Array";
+            }
+            else if constexpr (sizeof(T) == 2)
+            {
+                return std::is_signed_v<T> ? "Int16Array" : "Uint16Array";
+            }
+            else if constexpr (sizeof(T) == 4)
+            {
+                return std::is_signed_v<T> ? "Int32Array" : "Uint32Array";
+            }
+            else
+            {
+                return std::is_signed_v<T> ? "BigInt64Array" : "BigUint64Array";
+            }
+        }
+
+        /// \returns Whether or not a buffer of the given type holds elements of type `T`
+        template <typename T> bool matches(const std::string &type)
+        {
+            if (type == typeName<T>())
+            {
+                return true;
+            }
+
+            //* Bytes can be taken from any buffer, as long as it is not a view of wider elements
+            return sizeof(T) == 1 && (type == "ArrayBuffer" || type == "Uint8Array");
+        }
+    } // namespace Binary
+
+    namespace Helpers
+    {
+        template <typename T> nlohmann::json toJson(const T &value)
+        {
+            if constexpr (Traits::is_binary<T>::value)
+            {
+                using value_t = typename T::value_type;
+                return {{"_rpc_binary", Binary::encode(value.data(), value.size() * sizeof(value_t))},
+                        {"type", Binary::typeName<value_t>()}};
+            }
+            else
+            {
+                return nlohmann::json(value);
+            }
+        }
+
+        template <typename T> T fromJson(const nlohmann::json &j)
+        {
+            if constexpr (Traits::is_numeric_vector<T>::value)
+            {
+                if (Binary::isBinary(j))
+                {
+                    using value_t = typename T::value_type;
+                    const auto &data = j.at("_rpc_binary").get_ref<const std::string &>();
+
+                    //* The raw elements are only meaningful as the element type they were written as
+                    const auto type = j.find("type");
+                    if (type == j.end() || !type->is_string() ||
+                        !Binary::matches<value_t>(type->get_ref<const std::string &>()))
+                    {
+                        throw std::invalid_argument(std::string("Expected a ") + Binary::typeName<value_t>() +
+                                                    " but got " + (type != j.end() ? type->dump() : "no type"));
+                    }
+
+                    auto size = Binary::decodedSize(data);
+                    if (size % sizeof(value_t) != 0)
+                    {
+                        throw std::invalid_argument("Binary data does not match the element size");
+                    }
+
+                    T rtn(size / sizeof(value_t));
+                    if (!Binary::decode(data, rtn.data()))
+                    {
+                        throw std::invalid_argument("Binary data is not valid base64");
+                    }
+
+                    return rtn;
+                }
+            }
+
+            return j.get<T>();
+        }
+    } // namespace Helpers
+} // namespace Webview
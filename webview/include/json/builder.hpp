@@ -0,0 +1,40 @@
+#pragma once
+#include <json.hpp>
+#include <string>
+#include <vector>
+
+namespace Webview
+{
+    //* Builds a json value out of sax events, used for everything that can't be parsed into its target directly
+    class JsonBuilder : public nlohmann::json_sax<nlohmann::json>
+    {
+        nlohmann::json root;
+        std::string lastKey;
+        std::vector<nlohmann::json *> stack;
+
+        nlohmann::json *add(nlohmann::json &&);
+
+      public:
+        bool null() override;
+        bool boolean(bool) override;
+        bool number_integer(number_integer_t) override;
+        bool number_unsigned(number_unsigned_t) override;
+        bool number_float(number_float_t, const string_t &) override;
+        bool string(string_t &) override;
+        bool binary(binary_t &) override;
+
+        bool start_object(std::size_t) override;
+        bool key(string_t &) override;
+        bool end_object() override;
+
+        bool start_array(std::size_t) override;
+        bool end_array() override;
+
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) override;
+
+        /// \returns Whether or not the value is complete
+        bool done() const;
+        /// \returns The built value
+        nlohmann::json &get();
+    };
+} // namespace Webview
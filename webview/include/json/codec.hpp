@@ -0,0 +1,55 @@
+#pragma once
+#include <json.hpp>
+#include <string>
+
+namespace Webview
+{
+    //* Encodes the payloads that are exchanged with javascript, which are the messages javascript sends and the
+    //* results of its calls. Javascript uses the matching encoder that `getScript` installs as `window._rpc_codec`.
+    class Codec
+    {
+      public:
+        virtual ~Codec() = default;
+
+        /// \returns The javascript that makes `window._rpc_codec` use this encoding
+        virtual const std::string &getScript() const = 0;
+        /// \returns Whether or not encoded values are binary, they are then sent to javascript as base64
+        virtual bool isBinary() const = 0;
+
+        /// \returns The encoded value
+        virtual std::string encode(const nlohmann::json &) const = 0;
+        /// \effects Feeds the given message from javascript to the given handler
+        /// \returns Whether or not the message was valid
+        virtual bool decode(const std::string &, nlohmann::json_sax<nlohmann::json> &) const = 0;
+    };
+
+    class JsonCodec : public Codec
+    {
+      public:
+        const std::string &getScript() const override;
+        bool isBinary() const override;
+
+        std::string encode(const nlohmann::json &) const override;
+        bool decode(const std::string &, nlohmann::json_sax<nlohmann::json> &) const override;
+    };
+
+    class CborCodec : public Codec
+    {
+      public:
+        const std::string &getScript() const override;
+        bool isBinary() const override;
+
+        std::string encode(const nlohmann::json &) const override;
+        bool decode(const std::string &, nlohmann::json_sax<nlohmann::json> &) const override;
+    };
+
+    class MessagePackCodec : public Codec
+    {
+      public:
+        const std::string &getScript() const override;
+        bool isBinary() const override;
+
+        std::string encode(const nlohmann::json &) const override;
+        bool decode(const std::string &, nlohmann::json_sax<nlohmann::json> &) const override;
+    };
+} // namespace Webview
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <javascript/arguments.hpp>
+#include <javascript/call.hpp>
+#include <json.hpp>
+#include <json/builder.hpp>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Webview
+{
+    //* Parses a message from javascript, which is either a batch of calls and cancellations of calls or a single
+    //* response to a native call.
+    //* The parameters of a call are handed to the `Arguments` of the called function, which requires the function
+    //* id to be sent before them, otherwise they are parsed into a json value as a fallback.
+    class CallParser : public nlohmann::json_sax<nlohmann::json>
+    {
+      public:
+        using Lookup = std::function<std::shared_ptr<Arguments>(std::uint32_t)>;
+
+      private:
+        Lookup lookup;
+
+        std::size_t depth = 0;
+        std::size_t callDepth = 0; //* Depth of the call objects, which depends on whether or not they are batched
+        std::string lastKey;
+
+        FunctionCallRequest request{};
+        std::optional<nlohmann::json> result; //* Only set if the message is a response to a native call
+        std::optional<std::string> error;     //* Only set if the native call threw in javascript
+        bool cancel = false;                  //* Whether or not the message cancels a call
+
+        nlohmann::json_sax<nlohmann::json> *sink = nullptr; //* Receives the events of the current value
+        std::size_t sinkDepth = 0;
+        std::optional<JsonBuilder> builder;
+
+        std::vector<FunctionCallRequest> requests;
+        std::vector<NativeCallResponse> responses;
+        std::vector<std::uint32_t> cancellations;
+
+        /// \returns The handler of the value of the current key, or `nullptr` if there is no value expected
+        nlohmann::json_sax<nlohmann::json> *startValue();
+        bool endValue();
+
+        /// \returns Whether or not the current value is the sequence or the function of the call
+        bool isId() const;
+        bool setId(std::uint32_t);
+
+      public:
+        explicit CallParser(Lookup);
+
+        bool null() override;
+        bool boolean(bool) override;
+        bool number_integer(number_integer_t) override;
+        bool number_unsigned(number_unsigned_t) override;
+        bool number_float(number_float_t, const string_t &) override;
+        bool string(string_t &) override;
+        bool binary(binary_t &) override;
+
+        bool start_object(std::size_t) override;
+        bool key(string_t &) override;
+        bool end_object() override;
+
+        bool start_array(std::size_t) override;
+        bool end_array() override;
+
+        bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &) override;
+
+        std::vector<FunctionCallRequest> &getRequests();
+        std::vector<NativeCallResponse> &getResponses();
+        std::vector<std::uint32_t> &getCancellations();
+    };
+} // namespace Webview
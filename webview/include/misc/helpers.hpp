@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 #include <tuple>
 #include <type_traits>
@@ -27,5 +28,22 @@ namespace Webview
                 setTupleImpl<size>(tuple, func);
             }
         }
+
+        template <std::size_t I = 0, typename Tuple, typename Function>
+        void visitTuple(Tuple &tuple, std::size_t index, Function func)
+        {
+            //* Calls the given function with the element at the given runtime index, does nothing if it is out of range
+            if constexpr (I < std::tuple_size_v<Tuple>)
+            {
+                if (index == I)
+                {
+                    func(std::get<I>(tuple));
+                }
+                else
+                {
+                    visitTuple<I + 1>(tuple, index, func);
+                }
+            }
+        }
     } // namespace Helpers
 } // namespace Webview
\ No newline at end of file
@@ -3,9 +3,13 @@
 #include <memory>
 #include <optional>
 #include <tuple>
+#include <type_traits>
+#include <vector>
 
 namespace Webview
 {
+    template <typename T> class TypedArray;
+
     namespace Traits
     {
         template <typename T> struct func_traits : public func_traits<decltype(&T::operator())>
@@ -40,6 +44,24 @@ namespace Webview
             static const bool value = sizeof(test(reinterpret_cast<T *>(0))) == sizeof(std::uint16_t);
         };
 
+        //* Values that are sent to javascript as a TypedArray, which has to be asked for explicitly
+        template <typename T> struct is_binary : std::false_type
+        {
+        };
+        template <typename T> struct is_binary<TypedArray<T>> : std::true_type
+        {
+        };
+
+        //* Vectors of numbers, javascript may send these as an array or as a TypedArray
+        template <typename T> struct is_numeric_vector : is_binary<T>
+        {
+        };
+        template <typename T, typename A>
+        struct is_numeric_vector<std::vector<T, A>>
+            : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8>
+        {
+        };
+
         template <typename T, typename Tuple> struct has_type;
         template <typename T> struct has_type<T, std::tuple<>> : std::false_type
         {
@@ -52,6 +74,13 @@ namespace Webview
         {
         };
 
+        template <typename T, typename Tuple> struct is_first : std::false_type
+        {
+        };
+        template <typename T, typename... Ts> struct is_first<T, std::tuple<T, Ts...>> : std::true_type
+        {
+        };
+
         template <typename T, typename... O>
         constexpr auto ignoreFirstImpl([[maybe_unused]] const std::tuple<T, O...> &tuple)
         {
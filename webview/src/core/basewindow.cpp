@@ -1,110 +1,1262 @@
+#include <algorithm>
 #include <core/basewindow.hpp>
+#include <cstring>
 #include <exception>
+#include <iterator>
 #include <javascript/promise.hpp>
 #include <json/bindings.hpp>
-#include <regex>
+#include <json/parser.hpp>
 #include <stdexcept>
+#include <vector>
 
-const std::string Webview::BaseWindow::callbackFunctionDefinition = R"js(
+const Webview::Template Webview::BaseWindow::callbackFunctionDefinition = R"js(
 async function {0}(...param)
 {
+    return window._rpc_call({1}, param);
+}
+)js";
+const Webview::Template Webview::BaseWindow::cachedFunctionDefinition = R"js(
+async function {0}(...param)
+{
+    return window._rpc_cached({1}, param, {2}, {3});
+}
+)js";
+const std::string Webview::BaseWindow::setupRpc = R"js(
+window._rpc = {};
+// Sequences start anywhere, so that a resolution meant for the previous page hardly ever finds a call of this one
+window._rpc_seq = Math.floor(Math.random() * 0x7fffffff);
+window._rpc_queue = [];
+window._rpc_call = (id, param) => {
+    // A trailing abort signal cancels the call instead of being passed to the function
+    const last = param[param.length - 1];
+    const signal = typeof AbortSignal !== "undefined" && last instanceof AbortSignal ? param.pop() : null;
+    if (signal && signal.aborted)
+    {
+        return Promise.reject(window._rpc_reason(signal));
+    }
+
     const seq = ++window._rpc_seq;
-    const promise = new Promise((resolve) => {
+    const promise = new Promise((resolve, reject) => {
         window._rpc[seq] = {
-            resolve: resolve
+            resolve: resolve,
+            reject: reject
         };
+
+        if (signal)
+        {
+            const abort = () => {
+                delete window._rpc[seq];
+                reject(window._rpc_reason(signal));
+                window._rpc_send({ "seq": seq, "cancel": true });
+            };
+
+            signal.addEventListener("abort", abort);
+            window._rpc[seq].release = () => signal.removeEventListener("abort", abort);
+        }
+    });
+
+    // The function has to come before the parameters, so they can be parsed into its arguments directly
+    window._rpc_send({ "function": id, "seq": seq, "params": param.map(window._rpc_encode) });
+    return promise;
+};
+window._rpc_cache = {};
+window._rpc_cached = (id, param, size, ttl) => {
+    // Binary parameters and abort signals can't be told apart by their json, so these calls are not cached
+    if (param.some((value) => value instanceof ArrayBuffer || ArrayBuffer.isView(value) ||
+                              (typeof AbortSignal !== "undefined" && value instanceof AbortSignal)))
+    {
+        return window._rpc_call(id, param);
+    }
+
+    // Results are remembered as promises, so identical calls that are made at the same time are only sent once
+    const cache = window._rpc_cache[id] || (window._rpc_cache[id] = new Map());
+    const key = JSON.stringify(param);
+    const cached = cache.get(key);
+
+    cache.delete(key);
+    if (cached && (!ttl || cached.expiry > Date.now()))
+    {
+        cache.set(key, cached);
+        return cached.result;
+    }
+
+    const entry = { result: window._rpc_call(id, param), expiry: Date.now() + ttl };
+    entry.result.catch(() => {
+        if (cache.get(key) === entry)
+        {
+            cache.delete(key);
+        }
     });
-    window.external.invoke(JSON.stringify({
-        "seq": seq,
-        "params": param,
-        "function": "{0}"
-    }));
-    return JSON.parse(await promise);
+
+    cache.set(key, entry);
+    if (cache.size > size)
+    {
+        cache.delete(cache.keys().next().value);
+    }
+
+    return entry.result;
+};
+window._rpc_send = (message) => {
+    // Messages sent in the same microtask are sent as one batch
+    if (window._rpc_queue.push(message) === 1)
+    {
+        Promise.resolve().then(() => {
+            const messages = window._rpc_queue;
+            window._rpc_queue = [];
+            window._rpc_post(messages);
+        });
+    }
+};
+window._rpc_post = (message) => {
+    // Hosts that can read javascript values themselves get the message as it is, instead of its json. Posting clones
+    // the message, which only keeps what json would for plain values, anything else is sent as its json
+    const structured = window._rpc_structured && window._rpc_codec.structured && window._rpc_plain(message, 0);
+    window.external.invoke(structured ? message : window._rpc_codec.encode(message));
+};
+window._rpc_plain = (value, depth) => {
+    // Functions can't be cloned at all, other objects lose their prototype and with it toJSON
+    if (value === null || typeof value !== "object")
+    {
+        return typeof value !== "function" && typeof value !== "symbol" && typeof value !== "bigint";
+    }
+    const prototype = Object.getPrototypeOf(value);
+    if (depth >= 512 || Object.prototype.hasOwnProperty.call(value, "toJSON") ||
+        (!Array.isArray(value) && prototype !== Object.prototype && prototype !== null))
+    {
+        return false;
+    }
+
+    for (const key in value)
+    {
+        if (!window._rpc_plain(value[key], depth + 1))
+        {
+            return false;
+        }
+    }
+
+    return true;
+};
+window._rpc_reason = (signal) => {
+    return signal.reason !== undefined ? signal.reason : new DOMException("The call was aborted", "AbortError");
+};
+window._rpc_resolve = (results) => {
+    for (const [seq, result, binary, handle, error] of results)
+    {
+        if (window._rpc[seq])
+        {
+            if (window._rpc[seq].release)
+            {
+                window._rpc[seq].release();
+            }
+            if (error)
+            {
+                window._rpc[seq].reject(new Error(JSON.parse(error)));
+            }
+            else if (handle)
+            {
+                window._rpc[seq].resolve(window._rpc_fetch(handle));
+            }
+            else
+            {
+                window._rpc[seq].resolve(binary ? window._rpc_decode(binary) : window._rpc_codec.decode(result));
+            }
+            delete window._rpc[seq];
+        }
+    }
+};
+window._rpc_fetch = async (handle) => {
+    const response = await fetch(window._rpc_results + handle.id);
+    const buffer = await response.arrayBuffer();
+    if (!handle.type)
+    {
+        return window._rpc_codec.fromBytes(new Uint8Array(buffer));
+    }
+
+    return handle.type === "ArrayBuffer" ? buffer : new window[handle.type](buffer);
+};
+window._rpc_encode = (value) => {
+    if (!(value instanceof ArrayBuffer) && !ArrayBuffer.isView(value))
+    {
+        return value;
+    }
+
+    const bytes = value instanceof ArrayBuffer ? new Uint8Array(value)
+                                               : new Uint8Array(value.buffer, value.byteOffset, value.byteLength);
+
+    return { "_rpc_binary": window._rpc_base64(bytes), "type": value.constructor.name };
+};
+window._rpc_decode = (value) => {
+    const bytes = window._rpc_bytes(value._rpc_binary);
+    return value.type === "ArrayBuffer" ? bytes.buffer : new window[value.type](bytes.buffer);
+};
+window._rpc_base64 = (bytes) => {
+    let raw = "";
+    for (let i = 0; i < bytes.length; i += 0x8000)
+    {
+        raw += String.fromCharCode.apply(null, bytes.subarray(i, i + 0x8000));
+    }
+
+    return btoa(raw);
+};
+window._rpc_bytes = (base64) => {
+    const raw = atob(base64);
+    const bytes = new Uint8Array(raw.length);
+    for (let i = 0; i < raw.length; i++)
+    {
+        bytes[i] = raw.charCodeAt(i);
+    }
+
+    return bytes;
+};
+)js";
+const Webview::Template Webview::BaseWindow::resolveCall = "`{0}`],";
+const Webview::Template Webview::BaseWindow::resolveBinaryCall = "null,{0}],";
+const Webview::Template Webview::BaseWindow::resolveHandleCall = "null,null,{0}],";
+const Webview::Template Webview::BaseWindow::rejectCall = "null,null,null,`{0}`],";
+const std::string Webview::BaseWindow::resolveBatchBegin = "window._rpc_resolve([";
+const std::string Webview::BaseWindow::resolveBatchEnd = "]);";
+const Webview::Template Webview::BaseWindow::resolveNativeCall = R"js(
+(async () => {
+    // A function that throws or returns a promise that rejects fails the call, instead of leaving it pending
+    let result;
+    try
+    {
+        result = await {1};
+    }
+    catch (error)
+    {
+        window._rpc_post({ "seq": {0}, "error": String(error) });
+        return;
+    }
+
+    window._rpc_post({ "seq": {0}, "result": window._rpc_encode(result ? result : null) });
+})();
+)js";
+
+Webview::BaseWindow::BaseWindow(std::string identifier, std::size_t width, std::size_t height)
+    : width(width), height(height), identifier(std::move(identifier))
+{
+}
+
+bool Webview::BaseWindow::onClose()
+{
+    if (closeCallback)
+    {
+        return closeCallback();
+    }
+    return false;
+}
+
+void Webview::BaseWindow::onResize(std::size_t newWidth, std ::size_t newHeight)
+{
+    if (resizeCallback)
+    {
+        resizeCallback(newWidth, newHeight);
+    }
+}
+
+void Webview::BaseWindow::onNavigate(std::string newUrl)
+{
+    url = std::move(newUrl);
+
+    if (navigateCallback)
+    {
+        navigateCallback(url);
+    }
+}
+
+void Webview::BaseWindow::receiveMessage(std::string message)
+{
+    //* The page may navigate away before the message is handled on the parsing thread
+    const auto page = epoch.load();
+
+    std::shared_ptr<SerialExecutor> thread;
+    {
+        std::lock_guard lock(parserMutex);
+        thread = parser;
+    }
+
+    if (!thread)
+    {
+        handleRawCallRequest(message, page);
+        return;
+    }
+
+    //* Messages are handled one after another, as a call may be cancelled by a later message
+    thread->execute([this, message = std::move(message), page] { handleRawCallRequest(message, page); });
+}
+
+void Webview::BaseWindow::enableBackgroundParsing(bool enable)
+{
+    std::shared_ptr<SerialExecutor> previous;
+
+    {
+        std::lock_guard lock(parserMutex);
+        if (enable && !parser)
+        {
+            parser = std::make_shared<SerialExecutor>();
+        }
+        else if (!enable)
+        {
+            previous = std::move(parser);
+        }
+    }
+
+    //* The previous parser handles the messages it still has queued before it is gone, which is waited for without
+    //* holding the lock
+}
+
+bool Webview::BaseWindow::isParsingInBackground()
+{
+    std::lock_guard lock(parserMutex);
+    return parser != nullptr;
+}
+
+void Webview::BaseWindow::handleRawCallRequest(const std::string &rawRequest, std::uint32_t page)
+{
+    handleMessage(
+        [this, &rawRequest](nlohmann::json_sax<nlohmann::json> &sax) { return getCodec()->decode(rawRequest, sax); },
+        page);
+}
+
+void Webview::BaseWindow::handleMessage(const MessageReader &reader, std::uint32_t page)
+{
+    //* The parameters are parsed straight into the arguments of the called function
+    CallParser parser([this](std::uint32_t id) -> std::shared_ptr<Arguments> {
+        //* The parameters of cached functions are needed as json, as they are the key of the cache
+        //* The same goes for functions whose calls are deduplicated
+        if (const auto *exposed = functions.find(id);
+            exposed && !exposed->cache && !exposed->options.singleFlight)
+        {
+            return exposed->function->makeArguments();
+        }
+
+        return nullptr;
+    });
+
+    if (reader(parser))
+    {
+        //* Calls from javascript arrive in batches, responses to native calls arrive one by one
+        for (auto &response : parser.getResponses())
+        {
+            handleCallResponse(std::move(response));
+        }
+        for (auto &request : parser.getRequests())
+        {
+            request.epoch = page;
+            const auto call = request.id();
+
+            //* A call that fails only rejects itself, the rest of the batch is still handled
+            try
+            {
+                handleCallRequest(std::move(request));
+            }
+            catch (const std::exception &e)
+            {
+                reject(call, e.what());
+            }
+            catch (...)
+            {
+                reject(call, "Unknown error while handling the call");
+            }
+        }
+        //* A call may be cancelled in the same batch it was made in
+        for (const auto &seq : parser.getCancellations())
+        {
+            cancelCall(makeCallId(page, seq));
+        }
+    }
+}
+
+void Webview::BaseWindow::handleCallResponse(NativeCallResponse &&response)
+{
+    decltype(nativeCallRequests)::node_type request;
+    {
+        std::lock_guard lock(nativeCallRequestsMutex);
+        request = nativeCallRequests.extract(response.seq);
+    }
+
+    //* Resolved without holding the lock, so that the callback can call into javascript again
+    if (!request)
+    {
+        return;
+    }
+
+    if (response.error)
+    {
+        std::lock_guard lock(nativeCallRequestsMutex);
+        callStats.failed++;
+    }
+
+    //* This is called from the callbacks of the platform, which must not be left by an exception. Anything thrown by
+    //* the callbacks of the call is dropped.
+    try
+    {
+        if (response.error)
+        {
+            request.mapped().reject(
+                std::make_exception_ptr(CallError(CallError::Reason::Exception, std::move(*response.error))));
+        }
+        else
+        {
+            request.mapped().resolve(response.result);
+        }
+    }
+    catch (...)
+    {
+    }
+}
+
+void Webview::BaseWindow::sweep(std::chrono::steady_clock::time_point scheduled)
+{
+    std::vector<decltype(nativeCallRequests)::node_type> expired;
+
+    {
+        std::lock_guard lock(nativeCallRequestsMutex);
+        const auto now = std::chrono::steady_clock::now();
+
+        while (!callDeadlines.empty() && callDeadlines.begin()->first <= now)
+        {
+            if (auto request = nativeCallRequests.extract(callDeadlines.begin()->second); request)
+            {
+                expired.emplace_back(std::move(request));
+            }
+
+            callDeadlines.erase(callDeadlines.begin());
+        }
+
+        callStats.timedOut += expired.size();
+
+        //* Only the sweep that is scheduled for the earliest deadline schedules the next one
+        if (nextSweep == scheduled)
+        {
+            nextSweep.reset();
+            if (!callDeadlines.empty())
+            {
+                const auto next = callDeadlines.begin()->first;
+                nextSweep = next;
+
+                dispatch([this, next] { sweep(next); },
+                         std::chrono::ceil<std::chrono::milliseconds>(next - now));
+            }
+        }
+    }
+
+    for (auto &request : expired)
+    {
+        request.mapped().reject(std::make_exception_ptr(
+            CallError(CallError::Reason::Timeout, "Javascript did not respond to " + request.mapped().getName())));
+    }
+}
+
+void Webview::BaseWindow::abandonCalls()
+{
+    decltype(nativeCallRequests) abandoned;
+    std::vector<std::shared_ptr<CancellationToken>> cancelled;
+
+    {
+        std::lock_guard lock(nativeCallRequestsMutex);
+        abandoned.swap(nativeCallRequests);
+        callDeadlines.clear();
+        callStats.abandoned += abandoned.size();
+    }
+    {
+        //* Resolutions that were not sent yet are dropped with the page, the sequences of the next page start over
+        std::lock_guard lock(batchMutex);
+        epoch++;
+        batch.clear();
+        batchSize = 0;
+    }
+    {
+        //* Results that were parked for the previous page can't be fetched anymore, the next page may already have
+        //* parked some of its own
+        std::lock_guard lock(resultsMutex);
+        for (auto result = results.begin(); result != results.end();)
+        {
+            result = result->second.epoch != epoch ? results.erase(result) : std::next(result);
+        }
+    }
+    {
+        //* Calls of the next page must not join the flights of this one
+        std::lock_guard lock(flightsMutex);
+        flights.clear();
+        flightKeys.clear();
+    }
+    {
+        //* Cancelled calls stay registered until they are resolved, so that they free their slots
+        std::lock_guard lock(runningMutex);
+        for (const auto &[id, call] : running)
+        {
+            cancelled.emplace_back(call.token);
+        }
+    }
+
+    for (const auto &token : cancelled)
+    {
+        token->cancel();
+    }
+
+    for (auto &[seq, request] : abandoned)
+    {
+        request.reject(std::make_exception_ptr(CallError(
+            CallError::Reason::Abandoned, "The page navigated away before responding to " + request.getName())));
+    }
+}
+
+std::shared_ptr<Webview::CancellationToken> Webview::BaseWindow::getCancellation(CallId id)
+{
+    {
+        std::lock_guard lock(runningMutex);
+        if (auto call = running.find(id); call != running.end())
+        {
+            return call->second.token;
+        }
+    }
+
+    return std::make_shared<CancellationToken>();
+}
+
+void Webview::BaseWindow::cancelCall(CallId id)
+{
+    {
+        std::lock_guard lock(flightsMutex);
+        if (auto flight = flights.find(id); flight != flights.end())
+        {
+            //* The run is only cancelled once no call that joined it is left
+            if (!flight->second.waiters.empty())
+            {
+                flight->second.cancelled = true;
+                return;
+            }
+        }
+        else
+        {
+            for (auto &[leader, joined] : flights)
+            {
+                auto &waiters = joined.waiters;
+                if (auto waiter = std::find(waiters.begin(), waiters.end(), id); waiter != waiters.end())
+                {
+                    waiters.erase(waiter);
+                    if (!waiters.empty() || !joined.cancelled)
+                    {
+                        return;
+                    }
+
+                    id = leader;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<CancellationToken> token;
+
+    {
+        std::lock_guard lock(runningMutex);
+        if (auto call = running.find(id); call != running.end())
+        {
+            token = call->second.token;
+        }
+    }
+
+    //* Cancelled without holding the lock, so that the callbacks can resolve the call
+    if (token)
+    {
+        token->cancel();
+    }
+}
+
+const Webview::BaseWindow::Exposed *Webview::BaseWindow::getExposed(const std::string &name)
+{
+    std::lock_guard lock(functionsMutex);
+    if (auto id = functionIds.find(name); id != functionIds.end())
+    {
+        return functions.find(id->second);
+    }
+
+    return nullptr;
+}
+
+Webview::ResultCache::Stats Webview::BaseWindow::getCacheStats(const std::string &name)
+{
+    const auto *exposed = getExposed(name);
+    if (!exposed || !exposed->cache)
+    {
+        return {};
+    }
+
+    return exposed->cache->getStats();
+}
+
+Webview::ConcurrencyStats Webview::BaseWindow::getConcurrencyStats(const std::string &name)
+{
+    const auto *exposed = getExposed(name);
+    if (!exposed || !exposed->limiter)
+    {
+        return {};
+    }
+
+    std::lock_guard lock(exposed->limiter->mutex);
+    return exposed->limiter->stats;
+}
+
+void Webview::BaseWindow::setCallTimeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard lock(nativeCallRequestsMutex);
+    callTimeout = timeout;
+}
+
+void Webview::BaseWindow::setSyncBudget(std::chrono::milliseconds budget)
+{
+    syncBudget = budget;
+}
+
+std::vector<Webview::Promotion> Webview::BaseWindow::getPromotions()
+{
+    std::vector<Promotion> rtn;
+    std::lock_guard lock(functionsMutex);
+
+    for (const auto &[name, id] : functionIds)
+    {
+        if (const auto &timing = functions.find(id)->timing; timing && timing->promoted)
+        {
+            std::lock_guard timingLock(timing->mutex);
+            rtn.emplace_back(*timing->promotion);
+        }
+    }
+
+    return rtn;
+}
+
+Webview::CallStats Webview::BaseWindow::getCallStats()
+{
+    std::lock_guard lock(nativeCallRequestsMutex);
+
+    auto rtn = callStats;
+    rtn.pending = nativeCallRequests.size();
+
+    return rtn;
+}
+
+void Webview::BaseWindow::handleCallRequest(FunctionCallRequest &&request)
+{
+    //* Exposed functions are never removed, so the entry stays valid without holding a lock. This lets the function
+    //* itself use the window, e.g. to expose further functions.
+    const auto *exposed = functions.find(request.function);
+    if (!exposed)
+    {
+        reject(request.id(), "There is no function with the id " + std::to_string(request.function));
+        return;
+    }
+
+    const auto &[function, asyncFunction, options, limiter, cache, timing] = *exposed;
+
+    if (asyncFunction)
+    {
+        const auto call = request.id();
+
+        if (options.singleFlight)
+        {
+            //* The name is part of the key, as the flights of all functions share one map
+            auto key = function->getName() + '\0' + request.params.dump();
+
+            std::lock_guard lock(flightsMutex);
+            if (auto flight = flightKeys.find(key); flight != flightKeys.end())
+            {
+                flights.at(flight->second).waiters.emplace_back(call);
+                return;
+            }
+
+            flightKeys.emplace(key, call);
+            flights.emplace(call, Flight{std::move(key), {}});
+        }
+
+        auto token = std::make_shared<CancellationToken>();
+        {
+            std::lock_guard runningLock(runningMutex);
+            running.emplace(call, Running{token, limiter});
+        }
+
+        auto executor = options.executor ? options.executor : getExecutor();
+        auto start = [executor, request = std::move(request), asyncFunction, token, this]() mutable {
+            executor->execute([request = std::move(request), asyncFunction, token, this] {
+                //* Calls that were cancelled while they were queued are not run at all
+                if (token->isCancelled())
+                {
+                    resolve(request.id(), nullptr);
+                    return;
+                }
+
+                //* Parameters that can't be converted and functions that throw fail the call, instead of the worker
+                try
+                {
+                    if (request.arguments)
+                    {
+                        request.arguments->invoke(*this, request.id());
+                    }
+                    else
+                    {
+                        asyncFunction->getFunc()(*this, request.params, request.id());
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    finish(request.id());
+                    reject(request.id(), e.what());
+                }
+                catch (...)
+                {
+                    finish(request.id());
+                    reject(request.id(), "Unknown error in " + asyncFunction->getName());
+                }
+            });
+        };
+
+        if (!limiter)
+        {
+            start();
+            return;
+        }
+
+        std::unique_lock limiterLock(limiter->mutex);
+        auto &stats = limiter->stats;
+
+        if (stats.running < options.maxConcurrency)
+        {
+            stats.running++;
+            limiterLock.unlock();
+
+            start();
+            return;
+        }
+
+        std::optional<CallId> rejected;
+        if (options.policy == QueuePolicy::Reject ||
+            (options.policy == QueuePolicy::Queue && options.maxQueued && stats.waiting >= options.maxQueued))
+        {
+            stats.rejected++;
+            rejected = call;
+        }
+        else
+        {
+            if (options.maxQueued && stats.waiting >= options.maxQueued)
+            {
+                stats.dropped++;
+                stats.waiting--;
+
+                rejected = limiter->waiting.front().first;
+                limiter->waiting.pop_front();
+            }
+
+            stats.queued++;
+            stats.waiting++;
+            limiter->waiting.emplace_back(call, std::move(start));
+        }
+        limiterLock.unlock();
+
+        if (rejected)
+        {
+            reject(*rejected, *rejected == call ? "Too many concurrent calls to " + function->getName()
+                                               : "Dropped in favour of a newer call to " + function->getName());
+        }
+    }
+    else if (timing->promoted)
+    {
+        auto executor = options.executor ? options.executor : getExecutor();
+        executor->execute([this, exposed, request = std::move(request)]() mutable {
+            try
+            {
+                callSync(*exposed, request);
+            }
+            catch (const std::exception &e)
+            {
+                reject(request.id(), e.what());
+            }
+            catch (...)
+            {
+                reject(request.id(), "Unknown error in " + exposed->function->getName());
+            }
+        });
+    }
+    else if (const auto budget = syncBudget.load(); budget.count() > 0)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        callSync(*exposed, request);
+        const auto took = std::chrono::steady_clock::now() - start;
+
+        std::lock_guard lock(timing->mutex);
+
+        timing->calls++;
+        timing->total += took;
+
+        //* Calls that were started before the function was promoted still count, but only the first one promotes it
+        if (took > budget && !timing->promoted)
+        {
+            timing->promotion = Promotion{function->getName(), took, budget,
+                                          timing->total / static_cast<std::int64_t>(timing->calls), timing->calls};
+            timing->promoted = true;
+        }
+    }
+    else
+    {
+        callSync(*exposed, request);
+    }
+}
+
+void Webview::BaseWindow::callSync(const Exposed &exposed, FunctionCallRequest &request)
+{
+    const auto &function = exposed.function;
+    const auto &cache = exposed.cache;
+
+    if (cache)
+    {
+        //* Objects are dumped with sorted keys, so equal parameters always produce the same key
+        auto key = request.params.dump();
+        if (auto cached = cache->get(key); cached)
+        {
+            resolveEncoded(request.id(), *cached);
+            return;
+        }
+
+        const auto result = encodeResult(function->getFunc()(request.params));
+
+        std::string code;
+        appendResult(code, result);
+
+        //* Parked results can only be fetched once
+        if (!result.parked)
+        {
+            cache->put(std::move(key), code);
+        }
+
+        resolveEncoded(request.id(), code);
+    }
+    else if (request.arguments)
+    {
+        resolve(request.id(), request.arguments->invoke(*this, request.id()));
+    }
+    else
+    {
+        resolve(request.id(), function->getFunc()(request.params));
+    }
 }
-)js";
-const std::string Webview::BaseWindow::setupRpc = "window._rpc = {}; window._rpc_seq = 0;";
-const std::string Webview::BaseWindow::resolveCall = R"js(
-    window._rpc[{0}].resolve(`{1}`);
-    delete window._rpc[{0}];
-)js";
-const std::string Webview::BaseWindow::resolveNativeCall = R"js(
-window.external.invoke(JSON.stringify({
-    "seq": {0},
-    "result": {1} ? {1} : null
-}));
-)js";
 
-Webview::BaseWindow::BaseWindow(std::string identifier, std::size_t width, std::size_t height)
-    : width(width), height(height), identifier(std::move(identifier))
+std::shared_ptr<Webview::Executor> Webview::BaseWindow::getExecutor()
+{
+    std::lock_guard lock(executorMutex);
+    if (executor)
+    {
+        return executor;
+    }
+
+    if (!pool)
+    {
+        pool = std::make_shared<ThreadPool>(poolSize);
+    }
+
+    return pool;
+}
+
+void Webview::BaseWindow::setExecutor(std::shared_ptr<Executor> newExecutor)
 {
+    std::lock_guard lock(executorMutex);
+    executor = std::move(newExecutor);
 }
 
-bool Webview::BaseWindow::onClose()
+void Webview::BaseWindow::setWorkerCount(std::size_t size)
 {
-    if (closeCallback)
+    std::lock_guard lock(executorMutex);
+    poolSize = size;
+}
+
+std::shared_ptr<Webview::Codec> Webview::BaseWindow::getCodec()
+{
+    std::lock_guard lock(codecMutex);
+    return codec;
+}
+
+void Webview::BaseWindow::setCodec(std::shared_ptr<Codec> newCodec)
+{
+    if (!newCodec)
     {
-        return closeCallback();
+        newCodec = std::make_shared<JsonCodec>();
+    }
+
+    injectCode(newCodec->getScript());
+
+    {
+        std::lock_guard lock(codecMutex);
+        codec = std::move(newCodec);
+    }
+
+    //* Cached results are encoded with the previous codec
+    std::lock_guard lock(functionsMutex);
+    for (const auto &[name, id] : functionIds)
+    {
+        if (const auto &cache = functions.find(id)->cache; cache)
+        {
+            cache->clear();
+        }
     }
-    return false;
 }
 
-void Webview::BaseWindow::onResize(std::size_t newWidth, std ::size_t newHeight)
+void Webview::BaseWindow::finish(CallId id)
 {
-    if (resizeCallback)
+    std::shared_ptr<Limiter> limiter;
+
     {
-        resizeCallback(newWidth, newHeight);
+        std::lock_guard lock(runningMutex);
+        if (auto call = running.find(id); call != running.end())
+        {
+            limiter = std::move(call->second.limiter);
+            running.erase(call);
+        }
+    }
+
+    //* Calls that wait for a slot are not started anymore once the window shuts down
+    if (!limiter || closing)
+    {
+        return;
+    }
+
+    std::function<void()> next;
+
+    {
+        std::lock_guard lock(limiter->mutex);
+        if (limiter->waiting.empty())
+        {
+            limiter->stats.running--;
+            return;
+        }
+
+        //* The slot is handed to the oldest waiting call
+        next = std::move(limiter->waiting.front().second);
+        limiter->waiting.pop_front();
+        limiter->stats.waiting--;
     }
+
+    next();
 }
 
-void Webview::BaseWindow::onNavigate(std::string newUrl)
+Webview::BaseWindow::EncodedResult Webview::BaseWindow::encodeResult(const nlohmann::json &result)
 {
-    url = std::move(newUrl);
+    auto codec = getCodec();
+    EncodedResult rtn{};
 
-    if (navigateCallback)
+    //* Binary results are sent as they are, they already are as compact as they can get
+    rtn.binary = Binary::isBinary(result);
+    rtn.value = rtn.binary ? result.dump() : codec->encode(result);
+
+    if (auto handle = park(result, rtn.value); !handle.empty())
     {
-        navigateCallback(url);
+        rtn.value = std::move(handle);
+        rtn.parked = true;
+    }
+    else if (!rtn.binary && codec->isBinary())
+    {
+        rtn.value = Binary::encode(rtn.value.data(), rtn.value.size());
+    }
+
+    return rtn;
+}
+
+void Webview::BaseWindow::appendResult(std::string &code, const EncodedResult &result)
+{
+    if (result.parked)
+    {
+        resolveHandleCall.formatTo(code, result.value);
+    }
+    else if (result.binary)
+    {
+        resolveBinaryCall.formatTo(code, result.value);
+    }
+    else
+    {
+        resolveCall.formatTo(code, result.value);
+    }
+}
+
+bool Webview::BaseWindow::isCurrent(CallId id) const
+{
+    return !closing && static_cast<std::uint32_t>(id >> 32) == epoch;
+}
+
+void Webview::BaseWindow::beginResolution(CallId id)
+{
+    if (batch.empty())
+    {
+        batch = resolveBatchBegin;
+    }
+
+    //* Javascript only knows the sequence of the call
+    batch += '[';
+    batch += std::to_string(static_cast<std::uint32_t>(id));
+    batch += ',';
+}
+
+void Webview::BaseWindow::resolve(CallId id, const nlohmann::json &result)
+{
+    finish(id);
+    const auto waiters = land(id);
+
+    //* Checked again once the lock is held, this only saves encoding (and parking) results nobody waits for
+    if (!isCurrent(id))
+    {
+        return;
+    }
+
+    const auto encoded = encodeResult(result);
+
+    std::unique_lock lock(batchMutex);
+    if (!isCurrent(id))
+    {
+        return;
+    }
+
+    beginResolution(id);
+    appendResult(batch, encoded);
+
+    //* Parked results can only be fetched once, so every waiter gets its own
+    for (const auto &waiter : waiters)
+    {
+        beginResolution(waiter);
+        appendResult(batch, encoded.parked ? encodeResult(result) : encoded);
+    }
+
+    scheduleFlush(lock, 1 + waiters.size());
+}
+
+void Webview::BaseWindow::resolveEncoded(CallId id, const std::string &code)
+{
+    finish(id);
+
+    std::unique_lock lock(batchMutex);
+    if (!isCurrent(id))
+    {
+        return;
+    }
+
+    beginResolution(id);
+    batch += code;
+    scheduleFlush(lock);
+}
+
+void Webview::BaseWindow::reject(CallId id, const std::string &message)
+{
+    {
+        std::lock_guard lock(runningMutex);
+        running.erase(id);
+    }
+
+    const auto waiters = land(id);
+    const auto error = nlohmann::json(message).dump();
+
+    std::unique_lock lock(batchMutex);
+    if (!isCurrent(id))
+    {
+        return;
+    }
+
+    beginResolution(id);
+    rejectCall.formatTo(batch, error);
+
+    for (const auto &waiter : waiters)
+    {
+        beginResolution(waiter);
+        rejectCall.formatTo(batch, error);
+    }
+
+    scheduleFlush(lock, 1 + waiters.size());
+}
+
+std::vector<Webview::CallId> Webview::BaseWindow::land(CallId id)
+{
+    std::lock_guard lock(flightsMutex);
+
+    auto flight = flights.find(id);
+    if (flight == flights.end())
+    {
+        return {};
+    }
+
+    auto waiters = std::move(flight->second.waiters);
+    flightKeys.erase(flight->second.key);
+    flights.erase(flight);
+
+    return waiters;
+}
+
+void Webview::BaseWindow::scheduleFlush(std::unique_lock<std::mutex> &lock, std::size_t resolutions)
+{
+    batchSize += resolutions;
+
+    if (batchSize >= maxBatchSize)
+    {
+        lock.unlock();
+        flush();
+    }
+    else if (!flushScheduled)
+    {
+        flushScheduled = true;
+        auto latency = maxBatchLatency;
+
+        lock.unlock();
+        dispatch([this] { flush(); }, latency);
     }
 }
 
-void Webview::BaseWindow::handleRawCallRequest(const std::string &rawRequest)
+std::string Webview::BaseWindow::park(const nlohmann::json &result, std::string &encoded)
 {
-    auto parsed = nlohmann::json::parse(rawRequest, nullptr, false);
-    if (!parsed.is_discarded())
     {
-        if (parsed.find("result") != parsed.end())
+        std::lock_guard lock(resultsMutex);
+        if (largeResultThreshold == 0 || encoded.size() < largeResultThreshold)
         {
-            std::lock_guard lock(nativeCallRequestsMutex);
-            auto request = parsed.get<NativeCallResponse>();
-            if (nativeCallRequests.find(request.seq) != nativeCallRequests.end())
-            {
-                auto &function = nativeCallRequests.at(request.seq);
-                function.resolve(request.result);
-                nativeCallRequests.erase(request.seq);
-            }
+            return {};
         }
-        else
-        {
-            std::lock_guard lock(functionsMutex);
-            auto request = parsed.get<FunctionCallRequest>();
-            const auto &function = functions.at(request.function);
+    }
 
-            if (const auto *asyncFunction = dynamic_cast<const AsyncFunction *>(function.get()); asyncFunction)
-            {
-                auto future = std::make_shared<std::future<void>>();
-                *future = std::async(std::launch::async, [future, request, asyncFunction, this]() {
-                    asyncFunction->getFunc()(*this, request.params, request.seq);
-                });
-            }
-            else
-            {
-                const auto &result = function->getFunc()(request.params);
+    nlohmann::json handle;
+    std::string payload;
 
-                auto responseCode =
-                    std::regex_replace(resolveCall, std::regex(R"(\{0\})"), std::to_string(request.seq));
-                responseCode = std::regex_replace(responseCode, std::regex(R"(\{1\})"), result.dump());
-                runCode(responseCode);
-            }
+    if (Binary::isBinary(result))
+    {
+        //* Binary results are served as raw bytes, so they don't have to be decoded by javascript
+        const auto &data = result.at("_rpc_binary").get_ref<const std::string &>();
+        payload.resize(Binary::decodedSize(data));
+        Binary::decode(data, payload.data());
+
+        handle["type"] = result.at("type");
+    }
+    else
+    {
+        payload = std::move(encoded);
+    }
+
+    std::unique_lock lock(resultsMutex);
+    auto id = ++lastResult;
+    auto timeout = resultTimeout;
+    results.emplace(id, Parked{std::move(payload), epoch});
+    lock.unlock();
+
+    //* Javascript fetches the result right away, one that is still parked by then never will be
+    if (timeout.count() > 0)
+    {
+        dispatch([this, id] { takeResult(id); }, timeout);
+    }
+
+    handle["id"] = id;
+    return handle.dump();
+}
+
+std::optional<std::string> Webview::BaseWindow::takeResult(std::uint32_t id)
+{
+    std::lock_guard lock(resultsMutex);
+
+    auto result = results.find(id);
+    if (result == results.end())
+    {
+        return std::nullopt;
+    }
+
+    auto rtn = std::move(result->second.payload);
+    results.erase(result);
+
+    return rtn;
+}
+
+void Webview::BaseWindow::setLargeResultThreshold(std::size_t size, std::chrono::milliseconds timeout)
+{
+    std::lock_guard lock(resultsMutex);
+    largeResultThreshold = size;
+    resultTimeout = timeout;
+}
+
+void Webview::BaseWindow::flush()
+{
+    //* Swapped with the batch, so that the next batch starts out with the capacity of a previous one instead of
+    //* growing again. `runCode` still copies the code, as it is run later on the main thread.
+    //* The batch only holds resolutions of the page that is shown, as it is cleared when a new epoch starts. A script
+    //* that was handed over before the page navigated away may still run on the next one, whose sequences start
+    //* elsewhere.
+    thread_local std::string code;
+
+    {
+        std::lock_guard lock(batchMutex);
+        flushScheduled = false;
+
+        if (batchSize == 0)
+        {
+            return;
         }
+
+        batchStats.flushes++;
+        batchStats.resolutions += batchSize;
+        batchStats.largest = std::max(batchStats.largest, batchSize);
+
+        batch += resolveBatchEnd;
+        code.swap(batch);
+
+        batch.clear();
+        batchSize = 0;
+    }
+
+    runCode(code);
+}
+
+void Webview::BaseWindow::setBatchLimits(std::size_t maxSize, std::chrono::milliseconds maxLatency)
+{
+    std::lock_guard lock(batchMutex);
+    maxBatchSize = std::max<std::size_t>(maxSize, 1);
+    maxBatchLatency = maxLatency;
+}
+
+Webview::BatchStats Webview::BaseWindow::getBatchStats()
+{
+    std::lock_guard lock(batchMutex);
+    return batchStats;
+}
+
+Webview::ThreadPool::Stats Webview::BaseWindow::getWorkerStats()
+{
+    std::lock_guard lock(executorMutex);
+    if (!pool)
+    {
+        return {};
+    }
+
+    return pool->getStats();
+}
+
+void Webview::BaseWindow::shutdown()
+{
+    {
+        std::lock_guard lock(batchMutex);
+        closing = true;
+
+        batch.clear();
+        batchSize = 0;
+    }
+
+    //* Both are stopped instead of freed, so that neither is recreated by a call that is still being handled.
+    //* Messages are stopped first, as they may start further `AsyncFunction`s
+    std::shared_ptr<SerialExecutor> thread;
+    {
+        std::lock_guard lock(parserMutex);
+        thread = parser;
+    }
+    if (thread)
+    {
+        thread->stop();
+    }
+
+    std::shared_ptr<ThreadPool> workers;
+    {
+        std::lock_guard lock(executorMutex);
+        workers = pool;
+    }
+    if (workers)
+    {
+        workers->stop();
     }
 }
 
@@ -169,32 +1321,107 @@ void Webview::BaseWindow::setResizeCallback(std::function<void(std::size_t, std:
     resizeCallback = std::move(callback);
 }
 
-void Webview::BaseWindow::expose(const Function &function)
+void Webview::BaseWindow::expose(const Function &function, ExposeOptions options)
 {
     std::shared_ptr<Function> ptr;
+    const AsyncFunction *asyncFunction = nullptr;
 
-    try
+    if (function.getKind() == Function::Kind::Async)
     {
-        const auto &asyncFunction = dynamic_cast<const AsyncFunction &>(function);
-        ptr = std::make_shared<AsyncFunction>(asyncFunction);
+        auto copy = std::make_shared<AsyncFunction>(static_cast<const AsyncFunction &>(function));
+        asyncFunction = copy.get();
+        ptr = std::move(copy);
     }
-    catch ([[maybe_unused]] const std::exception &e)
+    else
     {
         ptr = std::make_shared<Function>(function);
     }
 
+    std::shared_ptr<Limiter> limiter;
+    if (options.maxConcurrency > 0)
+    {
+        limiter = std::make_shared<Limiter>();
+    }
+
+    //* Only plain functions are cached, as they are the ones that return their result
+    std::shared_ptr<ResultCache> cache;
+    if (options.cacheSize > 0 && !asyncFunction)
+    {
+        cache = std::make_shared<ResultCache>(options.cacheSize, options.cacheTtl);
+    }
+
     std::lock_guard lock(functionsMutex);
-    functions.emplace(function.getName(), ptr);
-    injectCode(std::regex_replace(callbackFunctionDefinition, std::regex(R"(\{0\})"), function.getName()));
+    if (functionIds.count(function.getName()))
+    {
+        return;
+    }
+
+    //* The function is registered before it is injected, so that it can be found once javascript calls it
+    const auto id = functions.add(Exposed{ptr, asyncFunction, options, std::move(limiter), std::move(cache),
+                                          asyncFunction ? nullptr : std::make_shared<Timing>()});
+    functionIds.emplace(function.getName(), id);
+
+    if (options.cacheSize > 0 && !asyncFunction)
+    {
+        injectCode(cachedFunctionDefinition.format(function.getName(), std::to_string(id),
+                                                   std::to_string(options.cacheSize),
+                                                   std::to_string(options.cacheTtl.count())));
+    }
+    else
+    {
+        injectCode(callbackFunctionDefinition.format(function.getName(), std::to_string(id)));
+    }
 }
 
-std::string Webview::BaseWindow::formatCode(const std::string &code)
+const std::string &Webview::BaseWindow::formatCode(const std::string &code, std::string &buffer)
 {
-    auto formattedCode = std::regex_replace(code, std::regex(R"rgx(\\")rgx"), R"(\\\")");
-    formattedCode = std::regex_replace(formattedCode, std::regex(R"rgx(\\n)rgx"), R"(\\n)");
-    formattedCode = std::regex_replace(formattedCode, std::regex(R"rgx(\\t)rgx"), R"(\\t)");
+    //* Every `\"`, `\n` and `\t` has to be escaped once more, otherwise it would be resolved by the template literal
+    //* the code (or the json it contains) is placed in. This is done in a single pass, `memchr` is vectorized by
+    //* the standard library and we only copy if there actually is something to escape.
+
+    const auto *begin = code.data();
+    const auto *end = begin + code.size();
+    const auto *last = begin;
+    const auto *current = begin;
+
+    bool escaped = false;
+    while (end - current > 1)
+    {
+        //* A trailing backslash can't start a sequence, so it is excluded from the search
+        current = static_cast<const char *>(std::memchr(current, '\\', static_cast<std::size_t>(end - current - 1)));
+        if (!current)
+        {
+            break;
+        }
+
+        const auto next = current[1];
+        if (next != '"' && next != 'n' && next != 't')
+        {
+            current++;
+            continue;
+        }
+
+        if (!escaped)
+        {
+            escaped = true;
+            buffer.clear();
+            buffer.reserve(code.size() + code.size() / 8);
+        }
+
+        buffer.append(last, current);
+        buffer.append(next == '"' ? 2 : 1, '\\');
 
-    return formattedCode;
+        last = current;
+        current += 2;
+    }
+
+    if (!escaped)
+    {
+        return code;
+    }
+
+    buffer.append(last, end);
+    return buffer;
 }
 
 #if defined(WEBVIEW_EMBEDDED)
@@ -214,7 +1441,9 @@ void Webview::BaseWindow::enableContextMenu(bool state)
     isContextMenuAllowed = state;
 }
 
-Webview::JavaScriptFunction &Webview::BaseWindow::callFunctionInternal(Webview::JavaScriptFunction &&function)
+void Webview::BaseWindow::callFunctionInternal(JavaScriptFunction &&function,
+                                               std::function<void(const nlohmann::json &)> callback,
+                                               std::function<void(std::exception_ptr)> errorCallback)
 {
     static std::atomic<std::uint32_t> seq = 0;
     auto sequence = ++seq;
@@ -222,7 +1451,14 @@ Webview::JavaScriptFunction &Webview::BaseWindow::callFunctionInternal(Webview::
     auto call = function.getName() + "(";
     for (const auto &argument : function.getArguments())
     {
-        call += argument.dump() + ",";
+        if (Binary::isBinary(argument))
+        {
+            call += "window._rpc_decode(" + argument.dump() + "),";
+        }
+        else
+        {
+            call += argument.dump() + ",";
+        }
     }
     if (!function.getArguments().empty())
     {
@@ -233,10 +1469,31 @@ Webview::JavaScriptFunction &Webview::BaseWindow::callFunctionInternal(Webview::
         call += ")";
     }
 
-    auto code = std::regex_replace(resolveNativeCall, std::regex(R"(\{0\})"), std::to_string(sequence));
-    code = std::regex_replace(code, std::regex(R"(\{1\})"), call);
-    runCode(code);
+    //* Registered before the code runs, so that the response can't arrive before its request
+    function.setCallback(std::move(callback), std::move(errorCallback));
+    {
+        std::lock_guard lock(nativeCallRequestsMutex);
 
-    std::lock_guard lock(nativeCallRequestsMutex);
-    return nativeCallRequests.emplace(sequence, function).first->second;
+        const auto timeout = function.getTimeout().count() > 0 ? function.getTimeout() : callTimeout;
+        if (timeout.count() > 0)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            callDeadlines.emplace(deadline, sequence);
+
+            if (!nextSweep || deadline < *nextSweep)
+            {
+                nextSweep = deadline;
+                dispatch([this, deadline] { sweep(deadline); }, timeout);
+            }
+        }
+
+        nativeCallRequests.emplace(sequence, function);
+    }
+
+    runCall(sequence, call);
+}
+
+void Webview::BaseWindow::runCall(std::uint32_t seq, const std::string &call)
+{
+    runCode(resolveNativeCall.format(std::to_string(seq), call));
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include <core/cache.hpp>
+
+Webview::ResultCache::ResultCache(std::size_t capacity, std::chrono::milliseconds ttl) : capacity(capacity), ttl(ttl)
+{
+}
+
+std::optional<std::string> Webview::ResultCache::get(const std::string &key)
+{
+    std::lock_guard lock(mutex);
+
+    auto entry = index.find(key);
+    if (entry == index.end())
+    {
+        stats.misses++;
+        return std::nullopt;
+    }
+
+    if (ttl.count() > 0 && entry->second->expiry <= std::chrono::steady_clock::now())
+    {
+        entries.erase(entry->second);
+        index.erase(entry);
+
+        stats.evictions++;
+        stats.misses++;
+        return std::nullopt;
+    }
+
+    entries.splice(entries.begin(), entries, entry->second);
+    stats.hits++;
+
+    return entry->second->value;
+}
+
+void Webview::ResultCache::put(std::string key, std::string value)
+{
+    std::lock_guard lock(mutex);
+    const auto expiry = std::chrono::steady_clock::now() + ttl;
+
+    if (auto entry = index.find(key); entry != index.end())
+    {
+        entry->second->value = std::move(value);
+        entry->second->expiry = expiry;
+        entries.splice(entries.begin(), entries, entry->second);
+        return;
+    }
+
+    if (entries.size() >= capacity)
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+
+    entries.push_front({key, std::move(value), expiry});
+    index.emplace(std::move(key), entries.begin());
+}
+
+void Webview::ResultCache::clear()
+{
+    std::lock_guard lock(mutex);
+    entries.clear();
+    index.clear();
+}
+
+Webview::ResultCache::Stats Webview::ResultCache::getStats()
+{
+    std::lock_guard lock(mutex);
+
+    auto rtn = stats;
+    rtn.size = entries.size();
+
+    return rtn;
+}
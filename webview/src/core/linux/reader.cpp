@@ -0,0 +1,121 @@
+#if defined(__linux__)
+#include <cmath>
+#include <core/linux/reader.hpp>
+
+Webview::ValueReader::ValueReader(nlohmann::json_sax<nlohmann::json> &sax) : sax(sax) {}
+
+bool Webview::ValueReader::isSkipped(JSCValue *value)
+{
+    return jsc_value_is_undefined(value);
+}
+
+bool Webview::ValueReader::readNumber(double number)
+{
+    if (!std::isfinite(number))
+    {
+        return sax.null();
+    }
+
+    if (std::trunc(number) == number && std::fabs(number) <= maxSafeInteger)
+    {
+        if (number >= 0)
+        {
+            return sax.number_unsigned(static_cast<nlohmann::json::number_unsigned_t>(number));
+        }
+        return sax.number_integer(static_cast<nlohmann::json::number_integer_t>(number));
+    }
+
+    buffer.clear();
+    return sax.number_float(number, buffer);
+}
+
+bool Webview::ValueReader::readString(JSCValue *value)
+{
+    std::unique_ptr<GBytes, decltype(&g_bytes_unref)> bytes(jsc_value_to_string_as_bytes(value), g_bytes_unref);
+
+    gsize size = 0;
+    const auto *data = static_cast<const char *>(g_bytes_get_data(bytes.get(), &size));
+    buffer.assign(data ? data : "", size);
+
+    return sax.string(buffer);
+}
+
+bool Webview::ValueReader::readArray(JSCValue *value)
+{
+    Value length(jsc_value_object_get_property(value, "length"));
+    const auto size = static_cast<std::size_t>(jsc_value_to_double(length.get()));
+
+    if (!sax.start_array(size))
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; size > i; i++)
+    {
+        Value item(jsc_value_object_get_property_at_index(value, static_cast<guint>(i)));
+        if (!(isSkipped(item.get()) ? sax.null() : read(item.get())))
+        {
+            return false;
+        }
+    }
+
+    return sax.end_array();
+}
+
+bool Webview::ValueReader::readObject(JSCValue *value)
+{
+    std::unique_ptr<gchar *, decltype(&g_strfreev)> names(jsc_value_object_enumerate_properties(value), g_strfreev);
+
+    if (!sax.start_object(static_cast<std::size_t>(-1)))
+    {
+        return false;
+    }
+
+    for (auto *name = names.get(); name && *name; name++)
+    {
+        Value member(jsc_value_object_get_property(value, *name));
+        if (isSkipped(member.get()))
+        {
+            continue;
+        }
+
+        buffer.assign(*name);
+        if (!sax.key(buffer) || !read(member.get()))
+        {
+            return false;
+        }
+    }
+
+    return sax.end_object();
+}
+
+bool Webview::ValueReader::read(JSCValue *value)
+{
+    if (jsc_value_is_null(value) || isSkipped(value))
+    {
+        return sax.null();
+    }
+    if (jsc_value_is_boolean(value))
+    {
+        return sax.boolean(jsc_value_to_boolean(value) != 0);
+    }
+    if (jsc_value_is_number(value))
+    {
+        return readNumber(jsc_value_to_double(value));
+    }
+    if (jsc_value_is_string(value))
+    {
+        return readString(value);
+    }
+    if (!jsc_value_is_object(value) || depth >= maxDepth)
+    {
+        return false;
+    }
+
+    depth++;
+    const auto result = jsc_value_is_array(value) ? readArray(value) : readObject(value);
+    depth--;
+
+    return result;
+}
+#endif
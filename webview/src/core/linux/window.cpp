@@ -1,6 +1,60 @@
 #if defined(__linux__)
+#include <cerrno>
+#include <core/linux/reader.hpp>
 #include <core/linux/window.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <json/builder.hpp>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace
+{
+    struct TaskSource
+    {
+        GSource source;
+        Webview::Window *window;
+    };
+
+    //* Custom schemes belong to the web context, which all windows share. They are registered once and their
+    //* requests are handed to the window of the web view that made them.
+    std::mutex windowsMutex;
+    std::map<WebKitWebView *, Webview::Window *> windows;
+
+    Webview::Window *windowOf(WebKitURISchemeRequest *request)
+    {
+        std::lock_guard lock(windowsMutex);
+        auto window = windows.find(webkit_uri_scheme_request_get_web_view(request));
+        return window != windows.end() ? window->second : nullptr;
+    }
+
+    struct Timer
+    {
+        Webview::Window *window;
+        guint id;
+        std::function<void()> func;
+    };
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+    struct PendingCall
+    {
+        Webview::Window *window;
+        std::uint32_t seq;
+    };
+
+    //* The body of an async function, webkit awaits the promise it returns. The result is encoded by the codec of the
+    //* page, so that it reads the same as the result of a call that is posted back as a message
+    const Webview::Template callBody = R"js(
+const result = await {0};
+return window._rpc_codec.encode(window._rpc_encode(result ? result : null));
+)js";
+#endif
+} // namespace
 
 Webview::Window::Window(std::size_t width, std::size_t height) : BaseWindow("", width, height)
 {
@@ -9,6 +63,24 @@ Webview::Window::Window(std::size_t width, std::size_t height) : BaseWindow("",
         throw std::runtime_error("Gtk init check failed");
     }
 
+    taskEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (taskEvent < 0)
+    {
+        throw std::runtime_error("Failed to create eventfd");
+    }
+
+    //* Runs with the same priority `g_idle_add` used, so that it doesn't get ahead of input and drawing
+    static GSourceFuncs taskSourceFuncs = {nullptr, nullptr, runTasks, nullptr, nullptr, nullptr};
+    taskSource = g_source_new(&taskSourceFuncs, sizeof(TaskSource));
+    reinterpret_cast<TaskSource *>(taskSource)->window = this;
+    g_source_add_unix_fd(taskSource, taskEvent, G_IO_IN);
+    g_source_set_priority(taskSource, G_PRIORITY_DEFAULT_IDLE);
+    g_source_attach(taskSource, nullptr);
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+    calls = g_cancellable_new();
+#endif
+
     window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_resizable(reinterpret_cast<GtkWindow *>(window), true);
     gtk_window_set_default_size(reinterpret_cast<GtkWindow *>(window), static_cast<int>(width),
@@ -28,10 +100,25 @@ Webview::Window::Window(std::size_t width, std::size_t height) : BaseWindow("",
     g_signal_connect(window, "delete_event", reinterpret_cast<GCallback>(closed), this);
     g_signal_connect(window, "configure-event", reinterpret_cast<GCallback>(resize), this);
 
+    {
+        std::lock_guard lock(windowsMutex);
+        windows.emplace(reinterpret_cast<WebKitWebView *>(webview), this);
+    }
+
+    static std::once_flag schemes;
+    std::call_once(schemes, [] {
+        auto *context = webkit_web_context_get_default();
+
 #if defined(WEBVIEW_EMBEDDED)
-    webkit_web_context_register_uri_scheme(webkit_web_context_get_default(), "embedded", onUriRequested, this, nullptr);
+        webkit_web_context_register_uri_scheme(context, "embedded", onUriRequested, nullptr, nullptr);
 #endif
 
+        auto *securityManager = webkit_web_context_get_security_manager(context);
+        webkit_security_manager_register_uri_scheme_as_secure(securityManager, "webview-rpc");
+        webkit_security_manager_register_uri_scheme_as_cors_enabled(securityManager, "webview-rpc");
+        webkit_web_context_register_uri_scheme(context, "webview-rpc", onResultRequested, nullptr, nullptr);
+    });
+
     g_signal_connect(contentManager, "script-message-received::external", reinterpret_cast<GCallback>(messageReceived),
                      this);
     g_signal_connect(reinterpret_cast<GObject *>(webview), "load-changed", reinterpret_cast<GCallback>(loadChanged),
@@ -41,7 +128,9 @@ Webview::Window::Window(std::size_t width, std::size_t height) : BaseWindow("",
 
     injectCode("window.external={invoke:arg=>window.webkit."
                "messageHandlers.external.postMessage(arg)};");
+    injectCode("window._rpc_results=\"webview-rpc://result/\";");
     injectCode(setupRpc);
+    injectCode(getCodec()->getScript());
 
     gtk_widget_grab_focus(webview);
     gtk_widget_show_all(scrollView);
@@ -52,6 +141,34 @@ Webview::Window::Window([[maybe_unused]] const std::string &identifier, std::siz
 {
 }
 
+Webview::Window::~Window()
+{
+    shutdown();
+
+    {
+        std::lock_guard lock(windowsMutex);
+        windows.erase(reinterpret_cast<WebKitWebView *>(webview));
+    }
+
+    {
+        std::lock_guard lock(timersMutex);
+        for (const auto &timer : timers)
+        {
+            g_source_remove(timer);
+        }
+        timers.clear();
+    }
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+    g_cancellable_cancel(calls);
+    g_object_unref(calls);
+#endif
+
+    g_source_destroy(taskSource);
+    g_source_unref(taskSource);
+    close(taskEvent);
+}
+
 void Webview::Window::show()
 {
     BaseWindow::show();
@@ -103,34 +220,138 @@ void Webview::Window::enableDevTools(bool state)
     webkit_settings_set_enable_developer_extras(settings, state);
 }
 
+void Webview::Window::wake()
+{
+    const std::uint64_t value = 1;
+    while (write(taskEvent, &value, sizeof(value)) < 0 && errno == EINTR)
+    {
+    }
+}
+
 void Webview::Window::runOnIdle(std::function<void()> func)
 {
-    auto *funcPtr = new std::function<void()>(std::move(func));
+    if (tasks.push(std::move(func)))
+    {
+        wake();
+    }
+}
+
+gboolean Webview::Window::runTasks(GSource *source, [[maybe_unused]] GSourceFunc callback,
+                                   [[maybe_unused]] gpointer data)
+{
+    auto *webview = reinterpret_cast<TaskSource *>(source)->window;
 
-    g_idle_add(
-        [](gpointer data) -> gboolean {
-            auto *func = reinterpret_cast<std::function<void()> *>(data);
-            (*func)();
+    std::uint64_t value = 0;
+    while (read(webview->taskEvent, &value, sizeof(value)) < 0 && errno == EINTR)
+    {
+    }
 
-            delete func;
-            return FALSE;
+    webview->tasks.drain();
+
+    return G_SOURCE_CONTINUE;
+}
+
+void Webview::Window::dispatch(std::function<void()> func, std::chrono::milliseconds delay)
+{
+    if (delay.count() <= 0)
+    {
+        runOnIdle(std::move(func));
+        return;
+    }
+
+    auto *timer = new Timer{this, 0, std::move(func)};
+
+    //* The timer can't run before its id is stored, as it takes the lock to forget it
+    std::lock_guard lock(timersMutex);
+    timer->id = g_timeout_add_full(
+        G_PRIORITY_DEFAULT, static_cast<guint>(delay.count()),
+        [](gpointer data) -> gboolean {
+            auto *timer = reinterpret_cast<Timer *>(data);
+            {
+                std::lock_guard lock(timer->window->timersMutex);
+                timer->window->timers.erase(timer->id);
+            }
+
+            timer->func();
+            return G_SOURCE_REMOVE;
         },
-        funcPtr);
+        timer, [](gpointer data) { delete reinterpret_cast<Timer *>(data); });
+
+    timers.emplace(timer->id);
 }
 
 void Webview::Window::runCode(const std::string &code)
 {
     runOnIdle([this, code] {
-        webkit_web_view_run_javascript(reinterpret_cast<WebKitWebView *>(webview), formatCode(code).c_str(), nullptr,
-                                       nullptr, nullptr);
+        webkit_web_view_run_javascript(reinterpret_cast<WebKitWebView *>(webview),
+                                       formatCode(code, formatBuffer).c_str(), nullptr, nullptr, nullptr);
+    });
+}
+
+#if WEBKIT_CHECK_VERSION(2, 40, 0)
+void Webview::Window::runCall(std::uint32_t seq, const std::string &call)
+{
+    //* Results are handled on the parsing thread if background parsing is enabled, they arrive as messages then
+    if (!directCalls || isParsingInBackground())
+    {
+        BaseWindow::runCall(seq, call);
+        return;
+    }
+
+    //* The result is returned straight from the evaluation instead of being posted back as a message
+    runOnIdle([this, seq, body = callBody.format(call)] {
+        webkit_web_view_call_async_javascript_function(reinterpret_cast<WebKitWebView *>(webview),
+                                                       formatCode(body, formatBuffer).c_str(), -1, nullptr, nullptr,
+                                                       nullptr, calls, callFinished, new PendingCall{this, seq});
     });
 }
 
+void Webview::Window::callFinished(GObject *object, GAsyncResult *result, gpointer arg)
+{
+    std::unique_ptr<PendingCall> call(reinterpret_cast<PendingCall *>(arg));
+
+    GError *error = nullptr;
+    Webview::Value value(webkit_web_view_call_async_javascript_function_finish(reinterpret_cast<WebKitWebView *>(object),
+                                                                               result, &error));
+
+    if (error)
+    {
+        //* The window is already gone if the call was cancelled
+        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+            call->window->handleCallResponse({call->seq, nullptr, std::string(error->message)});
+        }
+
+        g_error_free(error);
+        return;
+    }
+
+    JsonBuilder builder;
+    bool decoded = false;
+
+    if (jsc_value_is_string(value.get()))
+    {
+        auto *encoded = jsc_value_to_string(value.get());
+        decoded = call->window->getCodec()->decode(encoded, builder);
+        g_free(encoded);
+    }
+
+    if (!decoded)
+    {
+        call->window->handleCallResponse({call->seq, nullptr, std::string("The result could not be read")});
+        return;
+    }
+
+    call->window->handleCallResponse({call->seq, std::move(builder.get()), std::nullopt});
+}
+#endif
+
 void Webview::Window::injectCode(const std::string &code)
 {
+    std::string buffer;
     auto *manager = webkit_web_view_get_user_content_manager(reinterpret_cast<WebKitWebView *>(webview));
     webkit_user_content_manager_add_script(
-        manager, webkit_user_script_new(formatCode(code).c_str(), WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES,
+        manager, webkit_user_script_new(formatCode(code, buffer).c_str(), WEBKIT_USER_CONTENT_INJECT_ALL_FRAMES,
                                         WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START, nullptr, nullptr));
 }
 
@@ -152,12 +373,17 @@ void Webview::Window::destroy([[maybe_unused]] GtkWidget *widget, gpointer arg)
     webview->window = nullptr;
 }
 
-void Webview::Window::loadChanged(WebKitWebView *webkitwebview, [[maybe_unused]] WebKitLoadEvent event,
-                                  [[maybe_unused]] gpointer arg)
+void Webview::Window::loadChanged(WebKitWebView *webkitwebview, WebKitLoadEvent event, gpointer arg)
 {
-    if (event == WEBKIT_LOAD_FINISHED)
+    auto *webview = reinterpret_cast<Window *>(arg);
+
+    //* Once the new document is committed, the previous one can't respond to the calls it received anymore
+    if (event == WEBKIT_LOAD_COMMITTED)
+    {
+        webview->abandonCalls();
+    }
+    else if (event == WEBKIT_LOAD_FINISHED)
     {
-        auto *webview = reinterpret_cast<Window *>(arg);
         webview->onNavigate(webkit_web_view_get_uri(webkitwebview));
     }
 }
@@ -189,7 +415,43 @@ void Webview::Window::messageReceived([[maybe_unused]] WebKitUserContentManager
     auto *webview = reinterpret_cast<Window *>(arg);
 
     auto *value = webkit_javascript_result_get_js_value(result);
-    webview->handleRawCallRequest(jsc_value_to_string(value));
+
+    if (jsc_value_is_string(value))
+    {
+        auto *message = jsc_value_to_string(value);
+        webview->receiveMessage(message);
+        g_free(message);
+
+        return;
+    }
+
+    //* Structured messages are read from the javascript value, which can only be done on the main thread.
+    //* When parsing in the background the value is turned into json here instead, which is still cheaper than
+    //* having javascript stringify it.
+    if (webview->isParsingInBackground())
+    {
+        auto *message = jsc_value_to_json(value, 0);
+        webview->receiveMessage(message ? message : "");
+        g_free(message);
+
+        return;
+    }
+
+    webview->handleMessage([value](nlohmann::json_sax<nlohmann::json> &sax) { return Webview::ValueReader(sax).read(value); },
+                           webview->epoch);
+}
+
+void Webview::Window::enableDirectCalls(bool state)
+{
+    directCalls = state;
+}
+
+void Webview::Window::enableStructuredMessages(bool state)
+{
+    const auto *code = state ? "window._rpc_structured=true;" : "window._rpc_structured=false;";
+
+    injectCode(code);
+    runCode(code);
 }
 
 std::string Webview::Window::getUrl()
@@ -197,14 +459,45 @@ std::string Webview::Window::getUrl()
     return webkit_web_view_get_uri(reinterpret_cast<WebKitWebView *>(webview));
 }
 
+void Webview::Window::onResultRequested(WebKitURISchemeRequest *request, [[maybe_unused]] gpointer userData)
+{
+    auto *webview = windowOf(request);
+
+    std::string uri = webkit_uri_scheme_request_get_uri(request);
+    auto id = std::strtoul(uri.substr(uri.find_last_of('/') + 1).c_str(), nullptr, 10);
+
+    auto result = webview ? webview->takeResult(static_cast<std::uint32_t>(id)) : std::nullopt;
+    if (!result)
+    {
+        GError *error = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "Result does not exist");
+        webkit_uri_scheme_request_finish_error(request, error);
+        g_error_free(error);
+        return;
+    }
+
+    //* The payload is handed to the stream as is, it is freed once webkit is done with it
+    auto *payload = new std::string(std::move(*result));
+    auto size = static_cast<gint64>(payload->size());
+
+    GBytes *bytes = g_bytes_new_with_free_func(
+        payload->data(), payload->size(), [](gpointer data) { delete reinterpret_cast<std::string *>(data); },
+        payload);
+    GInputStream *stream = g_memory_input_stream_new_from_bytes(bytes);
+
+    webkit_uri_scheme_request_finish(request, stream, size, "application/octet-stream");
+
+    g_object_unref(stream);
+    g_bytes_unref(bytes);
+}
+
 #if defined(WEBVIEW_EMBEDDED)
 void Webview::Window::onUriRequested(WebKitURISchemeRequest *request, [[maybe_unused]] gpointer userData)
 {
-    auto *webview = reinterpret_cast<Window *>(userData);
+    auto *webview = windowOf(request);
     GInputStream *stream = nullptr;
 
     std::string uri = webkit_uri_scheme_request_get_uri(request);
-    if (uri.size() > 11)
+    if (webview && uri.size() > 11)
     {
         uri = uri.substr(11);
         auto fileName = uri.substr(uri.find_last_of('/') + 1);
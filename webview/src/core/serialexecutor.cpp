@@ -0,0 +1,58 @@
+#include <core/serialexecutor.hpp>
+
+Webview::SerialExecutor::SerialExecutor() : thread([this] { run(); }) {}
+
+Webview::SerialExecutor::~SerialExecutor()
+{
+    stop();
+}
+
+void Webview::SerialExecutor::stop()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopped = true;
+    }
+
+    condition.notify_one();
+
+    if (thread.joinable())
+    {
+        thread.join();
+    }
+}
+
+void Webview::SerialExecutor::execute(std::function<void()> task)
+{
+    if (!tasks.push(std::move(task)))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        woken = true;
+    }
+
+    condition.notify_one();
+}
+
+void Webview::SerialExecutor::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex);
+            condition.wait(lock, [this] { return woken || stopped; });
+
+            if (!woken)
+            {
+                return;
+            }
+
+            woken = false;
+        }
+
+        tasks.drain();
+    }
+}
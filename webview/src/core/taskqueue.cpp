@@ -0,0 +1,39 @@
+#include <core/taskqueue.hpp>
+
+bool Webview::TaskQueue::push(std::function<void()> task)
+{
+    std::lock_guard lock(mutex);
+    tasks.emplace_back(std::move(task));
+
+    const auto wake = !signaled;
+    signaled = true;
+
+    return wake;
+}
+
+void Webview::TaskQueue::drain()
+{
+    {
+        //* Everything that is queued from now on wakes the consumer again, so tasks that are queued while we drain are
+        //* left for the next wakeup, which also keeps a task that queues itself from starving the main loop
+        std::lock_guard lock(mutex);
+        signaled = false;
+        draining.swap(tasks);
+    }
+
+    //* A task that throws must not leave the tasks that ran behind, they would run again after the next swap
+    try
+    {
+        for (auto &task : draining)
+        {
+            task();
+        }
+    }
+    catch (...)
+    {
+        draining.clear();
+        throw;
+    }
+
+    draining.clear();
+}
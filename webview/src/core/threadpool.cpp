@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <core/threadpool.hpp>
+
+namespace
+{
+    //* Allows tasks that are posted from a worker to go straight into its own queue
+    thread_local const Webview::ThreadPool *currentPool = nullptr;
+    thread_local std::size_t currentIndex = 0;
+} // namespace
+
+Webview::ThreadPool::ThreadPool(std::size_t size)
+{
+    if (size == 0)
+    {
+        size = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+        queues.emplace_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < size; i++)
+    {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+Webview::ThreadPool::~ThreadPool()
+{
+    stop();
+}
+
+void Webview::ThreadPool::stop()
+{
+    {
+        std::lock_guard lock(sleepMutex);
+        stopped = true;
+    }
+    sleepCondition.notify_all();
+
+    for (auto &worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void Webview::ThreadPool::execute(std::function<void()> func)
+{
+    auto index = currentPool == this ? currentIndex : next++ % queues.size();
+
+    {
+        //* The lock makes sure that a worker can't miss the notification while it is about to go to sleep
+        std::lock_guard lock(sleepMutex);
+
+        //* Workers only exit once nothing is queued, so tasks that are posted while they drain still run
+        if (stopped && currentPool != this)
+        {
+            return;
+        }
+
+        queued++;
+    }
+
+    {
+        auto &queue = *queues[index];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back({std::move(func), std::chrono::steady_clock::now()});
+    }
+
+    sleepCondition.notify_one();
+}
+
+bool Webview::ThreadPool::pop(std::size_t index, Task &task)
+{
+    {
+        auto &own = *queues[index];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty())
+        {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < queues.size(); i++)
+    {
+        auto &other = *queues[(index + i) % queues.size()];
+        std::lock_guard lock(other.mutex);
+        if (!other.tasks.empty())
+        {
+            task = std::move(other.tasks.front());
+            other.tasks.pop_front();
+            stolen++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void Webview::ThreadPool::run(Task &task)
+{
+    queued--;
+    executed++;
+
+    auto wait =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - task.queuedAt).count();
+    totalWait += wait;
+
+    auto max = maxWait.load();
+    while (wait > max && !maxWait.compare_exchange_weak(max, wait))
+    {
+    }
+
+    //* A task that throws must not take the worker, and with it the whole process, down
+    try
+    {
+        task.func();
+    }
+    catch (...)
+    {
+    }
+}
+
+void Webview::ThreadPool::work(std::size_t index)
+{
+    currentPool = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        Task task;
+        if (pop(index, task))
+        {
+            run(task);
+            continue;
+        }
+
+        std::unique_lock lock(sleepMutex);
+        if (stopped && queued == 0)
+        {
+            break;
+        }
+
+        sleepCondition.wait(lock, [this] { return stopped || queued > 0; });
+    }
+}
+
+std::size_t Webview::ThreadPool::size() const
+{
+    return workers.size();
+}
+
+Webview::ThreadPool::Stats Webview::ThreadPool::getStats() const
+{
+    return {workers.size(),
+            queued.load(),
+            executed.load(),
+            stolen.load(),
+            std::chrono::nanoseconds(totalWait.load()),
+            std::chrono::nanoseconds(maxWait.load())};
+}
@@ -7,8 +7,9 @@
 #include <shellscalingapi.h>
 #endif
 
-#if defined(WEBVIEW_EMBEDDED)
 #include <Shlwapi.h>
+
+#if defined(WEBVIEW_EMBEDDED)
 #include <core/windows/mimes.hpp>
 #endif
 
@@ -77,6 +78,25 @@ Webview::Window::Window(std::string identifier, std::size_t width, std::size_t h
     }
 }
 
+Webview::Window::~Window()
+{
+    shutdown();
+
+    if (!hwnd)
+    {
+        return;
+    }
+
+    //* Timers and posted calls refer to this window, they must not run once it is gone
+    for (const auto &[id, func] : timers)
+    {
+        KillTimer(hwnd, id);
+    }
+    timers.clear();
+
+    SetWindowLongPtr(hwnd, GWLP_USERDATA, 0);
+}
+
 LRESULT CALLBACK Webview::Window::Window::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
 {
     auto *webview = reinterpret_cast<Window *>(GetWindowLongPtr(hwnd, GWLP_USERDATA));
@@ -110,6 +130,18 @@ LRESULT CALLBACK Webview::Window::Window::WndProc(HWND hwnd, UINT msg, WPARAM wP
             delete func;
         }
         break;
+        case WM_TIMER: {
+            auto timer = webview->timers.find(wParam);
+            if (timer != webview->timers.end())
+            {
+                KillTimer(hwnd, wParam);
+
+                auto func = std::move(timer->second);
+                webview->timers.erase(timer);
+                func();
+            }
+        }
+        break;
         default:
             return DefWindowProc(hwnd, msg, wParam, lParam);
         }
@@ -164,6 +196,15 @@ HRESULT Webview::Window::Window::onControllerCreated(ICoreWebView2Controller *co
         }).Get(),
         &navigationCompleted);
 
+    //* Once the new document is loading, the previous one can't respond to the calls it received anymore
+    EventRegistrationToken contentLoading;
+    webViewWindow->add_ContentLoading(
+        Microsoft::WRL::Callback<ICoreWebView2ContentLoadingEventHandler>([this](auto *, auto *) {
+            abandonCalls();
+            return S_OK;
+        }).Get(),
+        &contentLoading);
+
 #if defined(WEBVIEW_EMBEDDED)
     webViewWindow->AddWebResourceRequestedFilter(L"*", COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
     EventRegistrationToken webResourceRequested;
@@ -174,6 +215,15 @@ HRESULT Webview::Window::Window::onControllerCreated(ICoreWebView2Controller *co
         &webResourceRequested);
 #endif
 
+    webViewWindow->AddWebResourceRequestedFilter(L"https://webview-rpc.invalid/*",
+                                                 COREWEBVIEW2_WEB_RESOURCE_CONTEXT_ALL);
+    EventRegistrationToken resultRequested;
+    webViewWindow->add_WebResourceRequested(
+        Microsoft::WRL::Callback<ICoreWebView2WebResourceRequestedEventHandler>([=](auto *sender, auto *args) {
+            return onResultRequested(sender, args);
+        }).Get(),
+        &resultRequested);
+
     EventRegistrationToken messageReceived;
     webViewWindow->add_WebMessageReceived(
         Microsoft::WRL::Callback<ICoreWebView2WebMessageReceivedEventHandler>([=](auto *sender, auto *args) {
@@ -182,7 +232,9 @@ HRESULT Webview::Window::Window::onControllerCreated(ICoreWebView2Controller *co
         &messageReceived);
 
     injectCode("window.external.invoke=arg=>window.chrome.webview.postMessage(arg);");
+    injectCode("window._rpc_results=\"https://webview-rpc.invalid/result/\";");
     injectCode(setupRpc);
+    injectCode(getCodec()->getScript());
 
     for (const auto &func : runOnControllerCreated)
     {
@@ -200,7 +252,7 @@ HRESULT Webview::Window::Window::onMessageReceived([[maybe_unused]] ICoreWebView
     args->TryGetWebMessageAsString(&raw);
 
     auto message = narrow(raw);
-    BaseWindow::handleRawCallRequest(message);
+    receiveMessage(std::move(message));
 
     CoTaskMemFree(raw);
     return S_OK;
@@ -226,6 +278,49 @@ HRESULT Webview::Window::Window::onNavigationCompleted([[maybe_unused]] ICoreWeb
     return S_OK;
 }
 
+HRESULT Webview::Window::Window::onResultRequested([[maybe_unused]] ICoreWebView2 *sender,
+                                                   ICoreWebView2WebResourceRequestedEventArgs *args)
+{
+    wil::com_ptr<ICoreWebView2WebResourceRequest> req;
+    args->get_Request(&req);
+
+    wil::unique_cotaskmem_string rawURI;
+    req->get_Uri(&rawURI);
+
+    auto uri = narrow(rawURI.get());
+    if (uri.rfind("https://webview-rpc.invalid/result/", 0) != 0)
+    {
+        return S_OK;
+    }
+
+    auto id = std::strtoul(uri.substr(uri.find_last_of('/') + 1).c_str(), nullptr, 10);
+    auto result = takeResult(static_cast<std::uint32_t>(id));
+
+    wil::com_ptr<ICoreWebView2Environment> env;
+    wil::com_ptr<ICoreWebView2_2> webview2;
+    webViewWindow->QueryInterface(IID_PPV_ARGS(&webview2));
+    webview2->get_Environment(&env);
+
+    wil::com_ptr<ICoreWebView2WebResourceResponse> response;
+    if (result)
+    {
+        //* The stream is created with a reference of its own, which the pointer takes over
+        wil::com_ptr<IStream> stream;
+        stream.attach(
+            SHCreateMemStream(reinterpret_cast<const BYTE *>(result->data()), static_cast<UINT>(result->size())));
+        env->CreateWebResourceResponse(
+            stream.get(), 200, L"OK",
+            L"Content-Type: application/octet-stream\r\nAccess-Control-Allow-Origin: *", &response);
+    }
+    else
+    {
+        env->CreateWebResourceResponse(nullptr, 404, L"Not Found", L"Access-Control-Allow-Origin: *", &response);
+    }
+
+    args->put_Response(response.get());
+    return S_OK;
+}
+
 #if defined(WEBVIEW_EMBEDDED)
 HRESULT Webview::Window::Window::onWebResourceRequested([[maybe_unused]] ICoreWebView2 *sender,
                                                         ICoreWebView2WebResourceRequestedEventArgs *args)
@@ -251,7 +346,8 @@ HRESULT Webview::Window::Window::onWebResourceRequested([[maybe_unused]] ICoreWe
             webViewWindow->QueryInterface(IID_PPV_ARGS(&webview2));
             webview2->get_Environment(&env);
 
-            wil::com_ptr<IStream> stream = SHCreateMemStream(content.data, content.size);
+            wil::com_ptr<IStream> stream;
+            stream.attach(SHCreateMemStream(content.data, content.size));
 
             wil::com_ptr<ICoreWebView2WebResourceResponse> response;
             env->CreateWebResourceResponse(stream.get(), 200, L"OK",
@@ -352,6 +448,22 @@ void Webview::Window::dispatchMessage(std::function<void()> func)
     PostMessage(hwnd, WM_CALL, reinterpret_cast<ULONG_PTR>(funcPtr), 0);
 }
 
+void Webview::Window::dispatch(std::function<void()> func, std::chrono::milliseconds delay)
+{
+    if (delay.count() <= 0)
+    {
+        dispatchMessage(std::move(func));
+        return;
+    }
+
+    //* Timers have to be created by the thread that owns the window
+    dispatchMessage([this, func = std::move(func), delay]() mutable {
+        auto id = ++lastTimer;
+        timers.emplace(id, std::move(func));
+        SetTimer(hwnd, id, static_cast<UINT>(delay.count()), nullptr);
+    });
+}
+
 void Webview::Window::runCode(const std::string &code)
 {
     if (!webViewController)
@@ -359,7 +471,8 @@ void Webview::Window::runCode(const std::string &code)
         runOnControllerCreated.emplace_back([=] { runCode(code); });
         return;
     }
-    dispatchMessage([this, code] { webViewWindow->ExecuteScript(widen(formatCode(code)).c_str(), nullptr); });
+    dispatchMessage(
+        [this, code] { webViewWindow->ExecuteScript(widen(formatCode(code, formatBuffer)).c_str(), nullptr); });
 }
 
 void Webview::Window::injectCode(const std::string &code)
@@ -369,7 +482,8 @@ void Webview::Window::injectCode(const std::string &code)
         runOnControllerCreated.emplace_back([=] { injectCode(code); });
         return;
     }
-    webViewWindow->AddScriptToExecuteOnDocumentCreated(widen(formatCode(code)).c_str(), nullptr);
+    std::string buffer;
+    webViewWindow->AddScriptToExecuteOnDocumentCreated(widen(formatCode(code, buffer)).c_str(), nullptr);
 }
 
 void Webview::Window::onResize([[maybe_unused]] std::size_t _width, [[maybe_unused]] std::size_t _height)
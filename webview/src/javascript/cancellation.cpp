@@ -0,0 +1,40 @@
+#include <javascript/cancellation.hpp>
+
+bool Webview::CancellationToken::isCancelled() const
+{
+    return cancelled;
+}
+
+void Webview::CancellationToken::onCancel(std::function<void()> callback)
+{
+    {
+        std::lock_guard lock(callbacksMutex);
+        if (!cancelled)
+        {
+            callbacks.emplace_back(std::move(callback));
+            return;
+        }
+    }
+
+    callback();
+}
+
+void Webview::CancellationToken::cancel()
+{
+    std::vector<std::function<void()>> pending;
+
+    {
+        std::lock_guard lock(callbacksMutex);
+        if (cancelled.exchange(true))
+        {
+            return;
+        }
+
+        pending.swap(callbacks);
+    }
+
+    for (const auto &callback : pending)
+    {
+        callback();
+    }
+}
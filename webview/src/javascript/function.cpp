@@ -2,7 +2,7 @@
 #include <javascript/function.hpp>
 #include <json.hpp>
 
-std::function<nlohmann::json(const nlohmann::json &)> Webview::Function::getFunc() const
+const std::function<nlohmann::json(const nlohmann::json &)> &Webview::Function::getFunc() const
 {
     return parserFunction;
 }
@@ -12,8 +12,18 @@ std::string Webview::Function::getName() const
     return name;
 }
 
-std::function<void(Webview::BaseWindow &, const nlohmann::json &, std::uint32_t)> Webview::AsyncFunction::getFunc()
-    const
+Webview::Function::Kind Webview::Function::getKind() const
+{
+    return kind;
+}
+
+std::shared_ptr<Webview::Arguments> Webview::Function::makeArguments() const
+{
+    return argumentsFactory();
+}
+
+const std::function<void(Webview::BaseWindow &, const nlohmann::json &, Webview::CallId)> &
+Webview::AsyncFunction::getFunc() const
 {
     return parserFunction;
 }
@@ -30,10 +40,48 @@ std::string Webview::JavaScriptFunction::getName() const
 
 void Webview::JavaScriptFunction::resolve(const nlohmann::json &result)
 {
+    if (callback)
+    {
+        callback(result);
+        return;
+    }
+
     std::lock_guard guard(argumentsMutex);
     this->result.set_value(result);
 }
 
+void Webview::JavaScriptFunction::reject(std::exception_ptr error)
+{
+    if (callback)
+    {
+        if (errorCallback)
+        {
+            errorCallback(error);
+        }
+        return;
+    }
+
+    std::lock_guard guard(argumentsMutex);
+    this->result.set_exception(error);
+}
+
+void Webview::JavaScriptFunction::setCallback(std::function<void(const nlohmann::json &)> newCallback,
+                                              std::function<void(std::exception_ptr)> newErrorCallback)
+{
+    callback = std::move(newCallback);
+    errorCallback = std::move(newErrorCallback);
+}
+
+void Webview::JavaScriptFunction::setTimeout(std::chrono::milliseconds newTimeout)
+{
+    timeout = newTimeout;
+}
+
+std::chrono::milliseconds Webview::JavaScriptFunction::getTimeout() const
+{
+    return timeout;
+}
+
 std::shared_future<nlohmann::json> Webview::JavaScriptFunction::getResult()
 {
     std::lock_guard guard(argumentsMutex);
@@ -42,6 +90,7 @@ std::shared_future<nlohmann::json> Webview::JavaScriptFunction::getResult()
 
 Webview::JavaScriptFunction::JavaScriptFunction(JavaScriptFunction &other)
     : name(other.name), result((std::lock_guard(other.resultMutex), std::move(other.result))),
-      arguments((std::lock_guard(other.argumentsMutex), std::move(other.arguments)))
+      arguments((std::lock_guard(other.argumentsMutex), std::move(other.arguments))),
+      callback(std::move(other.callback)), errorCallback(std::move(other.errorCallback)), timeout(other.timeout)
 {
 }
\ No newline at end of file
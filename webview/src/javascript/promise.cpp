@@ -1,8 +1,20 @@
 #include <core/basewindow.hpp>
 #include <javascript/promise.hpp>
-#include <regex>
 
-Webview::Promise::Promise(Webview::BaseWindow &parent, std::uint32_t id) : id(id), parent(parent) {}
+Webview::Promise::Promise(Webview::BaseWindow &parent, CallId id)
+    : id(id), parent(parent), token(parent.getCancellation(id))
+{
+}
+
+bool Webview::Promise::isCancelled() const
+{
+    return token->isCancelled();
+}
+
+std::shared_ptr<Webview::CancellationToken> Webview::Promise::getToken() const
+{
+    return token;
+}
 
 void Webview::Promise::discard() const
 {
@@ -11,7 +23,12 @@ void Webview::Promise::discard() const
 
 void Webview::Promise::resolve(const nlohmann::json &result) const
 {
-    auto code = std::regex_replace(BaseWindow::resolveCall, std::regex(R"(\{0\})"), std::to_string(id));
-    code = std::regex_replace(code, std::regex(R"(\{1\})"), result.dump());
-    parent.runCode(code);
+    parent.resolve(id, result);
+}
+
+void Webview::Promise::reject(const std::string &message) const
+{
+    //* Unlike a resolution, a rejection does not free the concurrency slot of the call on its own
+    parent.finish(id);
+    parent.reject(id, message);
 }
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include <javascript/template.hpp>
+
+void Webview::Template::append(std::string &out, const std::string_view *values, std::size_t size) const
+{
+    auto required = out.size();
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto &part = parts[i];
+        required += part.text.size();
+
+        if (part.placeholder != noPlaceholder)
+        {
+            required += size > part.placeholder ? values[part.placeholder].size() : 3;
+        }
+    }
+
+    out.reserve(required);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto &part = parts[i];
+        out.append(part.text);
+
+        if (part.placeholder != noPlaceholder)
+        {
+            if (size > part.placeholder)
+            {
+                out.append(values[part.placeholder]);
+            }
+            else
+            {
+                //* Placeholders without a value are left untouched
+                out += '{';
+                out += static_cast<char>('0' + part.placeholder);
+                out += '}';
+            }
+        }
+    }
+}
@@ -0,0 +1,116 @@
+#include <array>
+#include <cstdint>
+#include <json/binary.hpp>
+
+namespace
+{
+    constexpr char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    constexpr auto reverseAlphabet = [] {
+        std::array<std::uint8_t, 256> rtn{};
+        for (auto &value : rtn)
+        {
+            value = 0xFF;
+        }
+        for (std::uint8_t i = 0; i < 64; i++)
+        {
+            rtn[static_cast<std::uint8_t>(alphabet[i])] = i;
+        }
+        return rtn;
+    }();
+} // namespace
+
+std::string Webview::Binary::encode(const void *data, std::size_t size)
+{
+    const auto *bytes = static_cast<const std::uint8_t *>(data);
+
+    std::string rtn;
+    rtn.resize((size + 2) / 3 * 4);
+
+    auto *out = rtn.data();
+    std::size_t i = 0;
+    for (; i + 2 < size; i += 3)
+    {
+        auto block = static_cast<std::uint32_t>(bytes[i] << 16 | bytes[i + 1] << 8 | bytes[i + 2]);
+        *out++ = alphabet[block >> 18 & 0x3F];
+        *out++ = alphabet[block >> 12 & 0x3F];
+        *out++ = alphabet[block >> 6 & 0x3F];
+        *out++ = alphabet[block & 0x3F];
+    }
+
+    if (i < size)
+    {
+        auto block = static_cast<std::uint32_t>(bytes[i] << 16 | (i + 1 < size ? bytes[i + 1] << 8 : 0));
+        *out++ = alphabet[block >> 18 & 0x3F];
+        *out++ = alphabet[block >> 12 & 0x3F];
+        *out++ = i + 1 < size ? alphabet[block >> 6 & 0x3F] : '=';
+        *out++ = '=';
+    }
+
+    return rtn;
+}
+
+std::size_t Webview::Binary::decodedSize(const std::string &data)
+{
+    auto size = data.size();
+    if (size % 4 != 0)
+    {
+        return 0;
+    }
+
+    std::size_t padding = 0;
+    while (padding < 2 && size > padding && data[size - padding - 1] == '=')
+    {
+        padding++;
+    }
+
+    return size / 4 * 3 - padding;
+}
+
+bool Webview::Binary::decode(const std::string &data, void *buffer)
+{
+    if (data.size() % 4 != 0)
+    {
+        return false;
+    }
+
+    auto *out = static_cast<std::uint8_t *>(buffer);
+    auto remaining = decodedSize(data);
+
+    for (std::size_t i = 0; i < data.size(); i += 4)
+    {
+        std::uint32_t block = 0;
+        for (std::size_t j = 0; j < 4; j++)
+        {
+            auto value = reverseAlphabet[static_cast<std::uint8_t>(data[i + j])];
+            if (value == 0xFF)
+            {
+                //* Padding is only allowed at the very end
+                if (data[i + j] != '=' || i + 4 != data.size() || j < 2)
+                {
+                    return false;
+                }
+                value = 0;
+            }
+            block = block << 6 | value;
+        }
+
+        for (std::size_t j = 0; j < 3 && remaining > 0; j++, remaining--)
+        {
+            *out++ = static_cast<std::uint8_t>(block >> (16 - j * 8));
+        }
+    }
+
+    return true;
+}
+
+bool Webview::Binary::isBinary(const nlohmann::json &j)
+{
+    if (!j.is_object() || j.size() != 2)
+    {
+        return false;
+    }
+
+    auto data = j.find("_rpc_binary");
+    return data != j.end() && data->is_string();
+}
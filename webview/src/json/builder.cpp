@@ -0,0 +1,116 @@
+#include <json/builder.hpp>
+
+nlohmann::json *Webview::JsonBuilder::add(nlohmann::json &&value)
+{
+    if (stack.empty())
+    {
+        root = std::move(value);
+        return &root;
+    }
+
+    auto &parent = *stack.back();
+    if (parent.is_array())
+    {
+        parent.push_back(std::move(value));
+        return &parent.back();
+    }
+
+    auto &slot = parent[lastKey];
+    slot = std::move(value);
+    return &slot;
+}
+
+bool Webview::JsonBuilder::null()
+{
+    add(nullptr);
+    return true;
+}
+
+bool Webview::JsonBuilder::boolean(bool value)
+{
+    add(value);
+    return true;
+}
+
+bool Webview::JsonBuilder::number_integer(number_integer_t value)
+{
+    add(value);
+    return true;
+}
+
+bool Webview::JsonBuilder::number_unsigned(number_unsigned_t value)
+{
+    add(value);
+    return true;
+}
+
+bool Webview::JsonBuilder::number_float(number_float_t value, [[maybe_unused]] const string_t &raw)
+{
+    add(value);
+    return true;
+}
+
+bool Webview::JsonBuilder::string(string_t &value)
+{
+    add(std::move(value));
+    return true;
+}
+
+bool Webview::JsonBuilder::binary(binary_t &value)
+{
+    add(nlohmann::json::binary(std::move(value)));
+    return true;
+}
+
+bool Webview::JsonBuilder::start_object([[maybe_unused]] std::size_t elements)
+{
+    stack.emplace_back(add(nlohmann::json::object()));
+    return true;
+}
+
+bool Webview::JsonBuilder::key(string_t &value)
+{
+    lastKey = std::move(value);
+    return true;
+}
+
+bool Webview::JsonBuilder::end_object()
+{
+    stack.pop_back();
+    return true;
+}
+
+bool Webview::JsonBuilder::start_array(std::size_t elements)
+{
+    auto *array = add(nlohmann::json::array());
+    if (elements != static_cast<std::size_t>(-1))
+    {
+        array->get_ref<nlohmann::json::array_t &>().reserve(elements);
+    }
+
+    stack.emplace_back(array);
+    return true;
+}
+
+bool Webview::JsonBuilder::end_array()
+{
+    stack.pop_back();
+    return true;
+}
+
+bool Webview::JsonBuilder::parse_error([[maybe_unused]] std::size_t position,
+                                       [[maybe_unused]] const std::string &lastToken,
+                                       [[maybe_unused]] const nlohmann::detail::exception &exception)
+{
+    return false;
+}
+
+bool Webview::JsonBuilder::done() const
+{
+    return stack.empty();
+}
+
+nlohmann::json &Webview::JsonBuilder::get()
+{
+    return root;
+}
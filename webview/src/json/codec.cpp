@@ -0,0 +1,639 @@
+#include <json/binary.hpp>
+#include <json/codec.hpp>
+
+namespace
+{
+    //* Javascript only has to encode what it sends and decode what it receives, so the binary formats are
+    //* implemented for the subset nlohmann::json produces and our messages consist of
+
+    const std::string binaryScript = R"js(
+window._rpc_writer = class
+{
+    constructor()
+    {
+        this.bytes = new Uint8Array(256);
+        this.view = new DataView(this.bytes.buffer);
+        this.length = 0;
+    }
+    reserve(size)
+    {
+        if (this.length + size > this.bytes.length)
+        {
+            const bytes = new Uint8Array(Math.max(this.bytes.length * 2, this.length + size));
+            bytes.set(this.bytes.subarray(0, this.length));
+            this.bytes = bytes;
+            this.view = new DataView(bytes.buffer);
+        }
+
+        const offset = this.length;
+        this.length += size;
+        return offset;
+    }
+    u8(value)
+    {
+        const offset = this.reserve(1);
+        this.bytes[offset] = value;
+    }
+    u16(value)
+    {
+        const offset = this.reserve(2);
+        this.view.setUint16(offset, value);
+    }
+    u32(value)
+    {
+        const offset = this.reserve(4);
+        this.view.setUint32(offset, value);
+    }
+    u64(value)
+    {
+        this.u32(Math.floor(value / 0x100000000));
+        this.u32(value >>> 0);
+    }
+    i64(value)
+    {
+        const high = Math.floor(value / 0x100000000);
+        const offset = this.reserve(4);
+        this.view.setInt32(offset, high);
+        this.u32(value - high * 0x100000000);
+    }
+    f64(value)
+    {
+        const offset = this.reserve(8);
+        this.view.setFloat64(offset, value);
+    }
+    raw(bytes)
+    {
+        const offset = this.reserve(bytes.length);
+        this.bytes.set(bytes, offset);
+    }
+    result()
+    {
+        return this.bytes.subarray(0, this.length);
+    }
+};
+window._rpc_reader = class
+{
+    constructor(bytes)
+    {
+        this.bytes = bytes;
+        this.view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+        this.offset = 0;
+    }
+    skip(size)
+    {
+        const offset = this.offset;
+        this.offset += size;
+        if (this.offset > this.bytes.length)
+        {
+            throw new RangeError("Unexpected end of data");
+        }
+
+        return offset;
+    }
+    u8() { return this.bytes[this.skip(1)]; }
+    u16() { return this.view.getUint16(this.skip(2)); }
+    u32() { return this.view.getUint32(this.skip(4)); }
+    u64() { return this.u32() * 0x100000000 + this.u32(); }
+    i8() { return this.view.getInt8(this.skip(1)); }
+    i16() { return this.view.getInt16(this.skip(2)); }
+    i32() { return this.view.getInt32(this.skip(4)); }
+    i64() { return this.i32() * 0x100000000 + this.u32(); }
+    f32() { return this.view.getFloat32(this.skip(4)); }
+    f64() { return this.view.getFloat64(this.skip(8)); }
+    raw(size)
+    {
+        const offset = this.skip(size);
+        return this.bytes.slice(offset, offset + size);
+    }
+    text(size)
+    {
+        const offset = this.skip(size);
+        return window._rpc_utf8.decode(this.bytes.subarray(offset, offset + size));
+    }
+};
+window._rpc_utf8 = new TextDecoder();
+window._rpc_members = (value) => {
+    // Skips the same members JSON.stringify would skip
+    return Object.keys(value).filter((key) => value[key] !== undefined && typeof value[key] !== "function");
+};
+window._rpc_use = (write, read) => {
+    window._rpc_codec = {
+        encode: (value) => {
+            const writer = new window._rpc_writer();
+            write(writer, value);
+            return window._rpc_base64(writer.result());
+        },
+        decode: (text) => read(new window._rpc_reader(window._rpc_bytes(text))),
+        fromBytes: (bytes) => read(new window._rpc_reader(bytes))
+    };
+};
+)js";
+
+    const std::string cborScript = binaryScript + R"js(
+(() => {
+    const encoder = new TextEncoder();
+    const head = (writer, major, value) => {
+        major <<= 5;
+        if (value < 24)
+        {
+            writer.u8(major | value);
+        }
+        else if (value <= 0xff)
+        {
+            writer.u8(major | 24);
+            writer.u8(value);
+        }
+        else if (value <= 0xffff)
+        {
+            writer.u8(major | 25);
+            writer.u16(value);
+        }
+        else if (value <= 0xffffffff)
+        {
+            writer.u8(major | 26);
+            writer.u32(value);
+        }
+        else
+        {
+            writer.u8(major | 27);
+            writer.u64(value);
+        }
+    };
+    const write = (writer, value) => {
+        if (value === null || value === undefined || typeof value === "function")
+        {
+            writer.u8(0xf6);
+        }
+        else if (typeof value === "boolean")
+        {
+            writer.u8(value ? 0xf5 : 0xf4);
+        }
+        else if (typeof value === "number")
+        {
+            if (Number.isSafeInteger(value))
+            {
+                value >= 0 ? head(writer, 0, value) : head(writer, 1, -1 - value);
+            }
+            else
+            {
+                writer.u8(0xfb);
+                writer.f64(value);
+            }
+        }
+        else if (typeof value === "string")
+        {
+            const bytes = encoder.encode(value);
+            head(writer, 3, bytes.length);
+            writer.raw(bytes);
+        }
+        else if (Array.isArray(value))
+        {
+            head(writer, 4, value.length);
+            for (const element of value)
+            {
+                write(writer, element);
+            }
+        }
+        else
+        {
+            if (typeof value.toJSON === "function")
+            {
+                return write(writer, value.toJSON());
+            }
+
+            const keys = window._rpc_members(value);
+            head(writer, 5, keys.length);
+            for (const key of keys)
+            {
+                write(writer, key);
+                write(writer, value[key]);
+            }
+        }
+    };
+    const half = (bits) => {
+        const sign = bits & 0x8000 ? -1 : 1;
+        const exponent = (bits >> 10) & 0x1f;
+        const fraction = bits & 0x3ff;
+
+        if (exponent === 0)
+        {
+            return sign * Math.pow(2, -14) * (fraction / 1024);
+        }
+        if (exponent === 31)
+        {
+            return fraction ? NaN : sign * Infinity;
+        }
+
+        return sign * Math.pow(2, exponent - 15) * (1 + fraction / 1024);
+    };
+    const read = (reader) => {
+        const initial = reader.u8();
+        const major = initial >> 5;
+        const info = initial & 0x1f;
+
+        if (major === 7)
+        {
+            switch (info)
+            {
+            case 20:
+                return false;
+            case 21:
+                return true;
+            case 22:
+            case 23:
+                return null;
+            case 25:
+                return half(reader.u16());
+            case 26:
+                return reader.f32();
+            case 27:
+                return reader.f64();
+            }
+
+            throw new TypeError("Unsupported CBOR value " + initial);
+        }
+
+        let value = info;
+        switch (info)
+        {
+        case 24:
+            value = reader.u8();
+            break;
+        case 25:
+            value = reader.u16();
+            break;
+        case 26:
+            value = reader.u32();
+            break;
+        case 27:
+            value = reader.u64();
+            break;
+        default:
+            if (info > 27)
+            {
+                throw new TypeError("Unsupported CBOR length " + info);
+            }
+        }
+
+        switch (major)
+        {
+        case 0:
+            return value;
+        case 1:
+            return -1 - value;
+        case 2:
+            return reader.raw(value);
+        case 3:
+            return reader.text(value);
+        case 4: {
+            const rtn = new Array(value);
+            for (let i = 0; i < value; i++)
+            {
+                rtn[i] = read(reader);
+            }
+            return rtn;
+        }
+        case 5: {
+            const rtn = {};
+            for (let i = 0; i < value; i++)
+            {
+                const key = read(reader);
+                rtn[key] = read(reader);
+            }
+            return rtn;
+        }
+        }
+
+        // Tags don't change the value for anything we send
+        return read(reader);
+    };
+
+    window._rpc_use(write, read);
+})();
+)js";
+
+    const std::string messagePackScript = binaryScript + R"js(
+(() => {
+    const encoder = new TextEncoder();
+    const head = (writer, size, fix, fixLimit, size8, size16, size32) => {
+        if (size < fixLimit)
+        {
+            writer.u8(fix | size);
+        }
+        else if (size8 && size <= 0xff)
+        {
+            writer.u8(size8);
+            writer.u8(size);
+        }
+        else if (size <= 0xffff)
+        {
+            writer.u8(size16);
+            writer.u16(size);
+        }
+        else
+        {
+            writer.u8(size32);
+            writer.u32(size);
+        }
+    };
+    const integer = (writer, value) => {
+        if (value >= 0)
+        {
+            if (value < 0x80)
+            {
+                writer.u8(value);
+            }
+            else if (value <= 0xff)
+            {
+                writer.u8(0xcc);
+                writer.u8(value);
+            }
+            else if (value <= 0xffff)
+            {
+                writer.u8(0xcd);
+                writer.u16(value);
+            }
+            else if (value <= 0xffffffff)
+            {
+                writer.u8(0xce);
+                writer.u32(value);
+            }
+            else
+            {
+                writer.u8(0xcf);
+                writer.u64(value);
+            }
+        }
+        else if (value >= -0x20)
+        {
+            writer.u8(value & 0xff);
+        }
+        else if (value >= -0x80)
+        {
+            writer.u8(0xd0);
+            writer.u8(value & 0xff);
+        }
+        else if (value >= -0x8000)
+        {
+            writer.u8(0xd1);
+            writer.u16(value & 0xffff);
+        }
+        else if (value >= -0x80000000)
+        {
+            writer.u8(0xd2);
+            writer.u32(value >>> 0);
+        }
+        else
+        {
+            writer.u8(0xd3);
+            writer.i64(value);
+        }
+    };
+    const write = (writer, value) => {
+        if (value === null || value === undefined || typeof value === "function")
+        {
+            writer.u8(0xc0);
+        }
+        else if (typeof value === "boolean")
+        {
+            writer.u8(value ? 0xc3 : 0xc2);
+        }
+        else if (typeof value === "number")
+        {
+            if (Number.isSafeInteger(value))
+            {
+                integer(writer, value);
+            }
+            else
+            {
+                writer.u8(0xcb);
+                writer.f64(value);
+            }
+        }
+        else if (typeof value === "string")
+        {
+            const bytes = encoder.encode(value);
+            head(writer, bytes.length, 0xa0, 32, 0xd9, 0xda, 0xdb);
+            writer.raw(bytes);
+        }
+        else if (Array.isArray(value))
+        {
+            head(writer, value.length, 0x90, 16, 0, 0xdc, 0xdd);
+            for (const element of value)
+            {
+                write(writer, element);
+            }
+        }
+        else
+        {
+            if (typeof value.toJSON === "function")
+            {
+                return write(writer, value.toJSON());
+            }
+
+            const keys = window._rpc_members(value);
+            head(writer, keys.length, 0x80, 16, 0, 0xde, 0xdf);
+            for (const key of keys)
+            {
+                write(writer, key);
+                write(writer, value[key]);
+            }
+        }
+    };
+    const array = (reader, size) => {
+        const rtn = new Array(size);
+        for (let i = 0; i < size; i++)
+        {
+            rtn[i] = read(reader);
+        }
+        return rtn;
+    };
+    const map = (reader, size) => {
+        const rtn = {};
+        for (let i = 0; i < size; i++)
+        {
+            const key = read(reader);
+            rtn[key] = read(reader);
+        }
+        return rtn;
+    };
+    const read = (reader) => {
+        const type = reader.u8();
+        if (type < 0x80)
+        {
+            return type;
+        }
+        if (type < 0x90)
+        {
+            return map(reader, type & 0x0f);
+        }
+        if (type < 0xa0)
+        {
+            return array(reader, type & 0x0f);
+        }
+        if (type < 0xc0)
+        {
+            return reader.text(type & 0x1f);
+        }
+        if (type >= 0xe0)
+        {
+            return type - 0x100;
+        }
+
+        switch (type)
+        {
+        case 0xc0:
+            return null;
+        case 0xc2:
+            return false;
+        case 0xc3:
+            return true;
+        case 0xc4:
+            return reader.raw(reader.u8());
+        case 0xc5:
+            return reader.raw(reader.u16());
+        case 0xc6:
+            return reader.raw(reader.u32());
+        case 0xca:
+            return reader.f32();
+        case 0xcb:
+            return reader.f64();
+        case 0xcc:
+            return reader.u8();
+        case 0xcd:
+            return reader.u16();
+        case 0xce:
+            return reader.u32();
+        case 0xcf:
+            return reader.u64();
+        case 0xd0:
+            return reader.i8();
+        case 0xd1:
+            return reader.i16();
+        case 0xd2:
+            return reader.i32();
+        case 0xd3:
+            return reader.i64();
+        case 0xd9:
+            return reader.text(reader.u8());
+        case 0xda:
+            return reader.text(reader.u16());
+        case 0xdb:
+            return reader.text(reader.u32());
+        case 0xdc:
+            return array(reader, reader.u16());
+        case 0xdd:
+            return array(reader, reader.u32());
+        case 0xde:
+            return map(reader, reader.u16());
+        case 0xdf:
+            return map(reader, reader.u32());
+        }
+
+        throw new TypeError("Unsupported MessagePack type " + type);
+    };
+
+    window._rpc_use(write, read);
+})();
+)js";
+
+    const std::string jsonScript = R"js(
+window._rpc_codec = {
+    structured: true,
+    encode: (value) => JSON.stringify(value),
+    decode: (text) => JSON.parse(text),
+    fromBytes: (bytes) => JSON.parse(new TextDecoder().decode(bytes))
+};
+)js";
+
+    bool decodeBinary(const std::string &message, nlohmann::json_sax<nlohmann::json> &sax,
+                      nlohmann::json::input_format_t format)
+    {
+        //* Binary messages arrive as base64, as the bridge only transports strings
+        std::string bytes(Webview::Binary::decodedSize(message), '\0');
+        if (!Webview::Binary::decode(message, bytes.data()))
+        {
+            return false;
+        }
+
+        return nlohmann::json::sax_parse(bytes, &sax, format);
+    }
+} // namespace
+
+const std::string &Webview::JsonCodec::getScript() const
+{
+    return jsonScript;
+}
+
+bool Webview::JsonCodec::isBinary() const
+{
+    return false;
+}
+
+std::string Webview::JsonCodec::encode(const nlohmann::json &value) const
+{
+    //* `dump` sets up a new serializer for every value, which allocates its output adapter each time. Reusing one
+    //* takes nlohmann's internal serializer, so it is only done for the versions it was checked against and other
+    //* versions fall back to `dump`
+#if NLOHMANN_JSON_VERSION_MAJOR == 3 && NLOHMANN_JSON_VERSION_MINOR == 11
+    using serializer_t = nlohmann::detail::serializer<nlohmann::json>;
+    thread_local std::string buffer;
+    thread_local serializer_t serializer(nlohmann::detail::output_adapter<char>(buffer), ' ');
+
+    buffer.clear();
+    serializer.dump(value, false, false, 0);
+
+    return buffer;
+#else
+    return value.dump();
+#endif
+}
+
+bool Webview::JsonCodec::decode(const std::string &message, nlohmann::json_sax<nlohmann::json> &sax) const
+{
+    return nlohmann::json::sax_parse(message, &sax);
+}
+
+const std::string &Webview::CborCodec::getScript() const
+{
+    return cborScript;
+}
+
+bool Webview::CborCodec::isBinary() const
+{
+    return true;
+}
+
+std::string Webview::CborCodec::encode(const nlohmann::json &value) const
+{
+    std::string rtn;
+    nlohmann::json::to_cbor(value, rtn);
+    return rtn;
+}
+
+bool Webview::CborCodec::decode(const std::string &message, nlohmann::json_sax<nlohmann::json> &sax) const
+{
+    return decodeBinary(message, sax, nlohmann::json::input_format_t::cbor);
+}
+
+const std::string &Webview::MessagePackCodec::getScript() const
+{
+    return messagePackScript;
+}
+
+bool Webview::MessagePackCodec::isBinary() const
+{
+    return true;
+}
+
+std::string Webview::MessagePackCodec::encode(const nlohmann::json &value) const
+{
+    std::string rtn;
+    nlohmann::json::to_msgpack(value, rtn);
+    return rtn;
+}
+
+bool Webview::MessagePackCodec::decode(const std::string &message, nlohmann::json_sax<nlohmann::json> &sax) const
+{
+    return decodeBinary(message, sax, nlohmann::json::input_format_t::msgpack);
+}
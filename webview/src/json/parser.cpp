@@ -0,0 +1,288 @@
+#include <json/parser.hpp>
+
+Webview::CallParser::CallParser(Lookup lookup) : lookup(std::move(lookup)) {}
+
+nlohmann::json_sax<nlohmann::json> *Webview::CallParser::startValue()
+{
+    if (callDepth == 0 || depth != callDepth)
+    {
+        return nullptr;
+    }
+
+    if (lastKey == "params" && request.arguments)
+    {
+        return request.arguments.get();
+    }
+
+    builder.emplace();
+    return &*builder;
+}
+
+bool Webview::CallParser::endValue()
+{
+    if (builder)
+    {
+        if (lastKey == "params")
+        {
+            request.params = std::move(builder->get());
+        }
+        else if (lastKey == "result")
+        {
+            result = std::move(builder->get());
+        }
+
+        builder.reset();
+    }
+
+    sink = nullptr;
+    return true;
+}
+
+bool Webview::CallParser::isId() const
+{
+    return depth == callDepth && (lastKey == "seq" || lastKey == "function");
+}
+
+bool Webview::CallParser::setId(std::uint32_t id)
+{
+    if (lastKey == "seq")
+    {
+        request.seq = id;
+        return true;
+    }
+
+    request.function = id;
+
+    //* Parameters that arrived before the function already are a json value
+    if (request.params.is_null())
+    {
+        request.arguments = lookup(id);
+    }
+
+    return true;
+}
+
+bool Webview::CallParser::null()
+{
+    if (sink)
+    {
+        return sink->null();
+    }
+
+    auto *target = startValue();
+    return target && target->null() && endValue();
+}
+
+bool Webview::CallParser::boolean(bool value)
+{
+    if (sink)
+    {
+        return sink->boolean(value);
+    }
+    if (depth == callDepth && lastKey == "cancel")
+    {
+        cancel = value;
+        return true;
+    }
+
+    auto *target = startValue();
+    return target && target->boolean(value) && endValue();
+}
+
+bool Webview::CallParser::number_integer(number_integer_t value)
+{
+    if (sink)
+    {
+        return sink->number_integer(value);
+    }
+    if (isId())
+    {
+        return setId(static_cast<std::uint32_t>(value));
+    }
+
+    auto *target = startValue();
+    return target && target->number_integer(value) && endValue();
+}
+
+bool Webview::CallParser::number_unsigned(number_unsigned_t value)
+{
+    if (sink)
+    {
+        return sink->number_unsigned(value);
+    }
+    if (isId())
+    {
+        return setId(static_cast<std::uint32_t>(value));
+    }
+
+    auto *target = startValue();
+    return target && target->number_unsigned(value) && endValue();
+}
+
+bool Webview::CallParser::number_float(number_float_t value, const string_t &raw)
+{
+    if (sink)
+    {
+        return sink->number_float(value, raw);
+    }
+    if (isId())
+    {
+        return setId(static_cast<std::uint32_t>(value));
+    }
+
+    auto *target = startValue();
+    return target && target->number_float(value, raw) && endValue();
+}
+
+bool Webview::CallParser::string(string_t &value)
+{
+    if (sink)
+    {
+        return sink->string(value);
+    }
+    if (depth == callDepth && lastKey == "error")
+    {
+        error = std::move(value);
+        return true;
+    }
+
+    auto *target = startValue();
+    return target && target->string(value) && endValue();
+}
+
+bool Webview::CallParser::binary(binary_t &value)
+{
+    if (sink)
+    {
+        return sink->binary(value);
+    }
+
+    auto *target = startValue();
+    return target && target->binary(value) && endValue();
+}
+
+bool Webview::CallParser::start_object(std::size_t elements)
+{
+    if (sink)
+    {
+        sinkDepth++;
+        return sink->start_object(elements);
+    }
+    if (auto *target = startValue(); target)
+    {
+        sink = target;
+        sinkDepth = 1;
+        return sink->start_object(elements);
+    }
+
+    if (depth == 0)
+    {
+        callDepth = 1;
+    }
+    if (depth + 1 != callDepth)
+    {
+        return false;
+    }
+
+    depth++;
+    request = {};
+    result.reset();
+    error.reset();
+    cancel = false;
+
+    return true;
+}
+
+bool Webview::CallParser::key(string_t &value)
+{
+    if (sink)
+    {
+        return sink->key(value);
+    }
+
+    lastKey = std::move(value);
+    return true;
+}
+
+bool Webview::CallParser::end_object()
+{
+    if (sink)
+    {
+        return sink->end_object() && (--sinkDepth != 0 || endValue());
+    }
+
+    if (cancel)
+    {
+        cancellations.push_back(request.seq);
+    }
+    else if (result || error)
+    {
+        responses.push_back({request.seq, result ? std::move(*result) : nlohmann::json(), std::move(error)});
+    }
+    else
+    {
+        requests.emplace_back(std::move(request));
+    }
+
+    depth--;
+    return true;
+}
+
+bool Webview::CallParser::start_array(std::size_t elements)
+{
+    if (sink)
+    {
+        sinkDepth++;
+        return sink->start_array(elements);
+    }
+    if (auto *target = startValue(); target)
+    {
+        sink = target;
+        sinkDepth = 1;
+        return sink->start_array(elements);
+    }
+
+    //* Only the outermost value may be an array, which holds a batch of calls
+    if (depth != 0)
+    {
+        return false;
+    }
+
+    depth++;
+    callDepth = 2;
+
+    return true;
+}
+
+bool Webview::CallParser::end_array()
+{
+    if (sink)
+    {
+        return sink->end_array() && (--sinkDepth != 0 || endValue());
+    }
+
+    depth--;
+    return true;
+}
+
+bool Webview::CallParser::parse_error([[maybe_unused]] std::size_t position,
+                                      [[maybe_unused]] const std::string &lastToken,
+                                      [[maybe_unused]] const nlohmann::detail::exception &exception)
+{
+    return false;
+}
+
+std::vector<Webview::FunctionCallRequest> &Webview::CallParser::getRequests()
+{
+    return requests;
+}
+
+std::vector<Webview::NativeCallResponse> &Webview::CallParser::getResponses()
+{
+    return responses;
+}
+
+std::vector<std::uint32_t> &Webview::CallParser::getCancellations()
+{
+    return cancellations;
+}